@@ -1,5 +1,5 @@
 workspace "psychobox"
-  configurations { "Debug", "Release" }
+  configurations { "Debug", "Release", "ReleaseChecked" }
   location "bin"
   system "Windows"
   architecture "x86_64"
@@ -27,4 +27,44 @@ project "psychobox"
     targetdir "bin/Release"
     linkoptions { "../icon.res" }
     buildoptions { "/O2", "/MD" }
-    optimize "On"
\ No newline at end of file
+    optimize "On"
+
+  -- release with the cheap level sanity checks, see SanityChecks in gameplay.hpp
+  filter "configurations:ReleaseChecked"
+    targetdir "bin/ReleaseChecked"
+    linkoptions { "../icon.res" }
+    buildoptions { "/O2", "/MD" }
+    optimize "On"
+    defines { "PSYCHOBOX_SANITY_CHEAP" }
+-- headless console tools (level analyzer and friends). only pulls in the simulation code.
+project "psychobox_tools"
+  kind "ConsoleApp"
+  language "C++"
+  debugdir "."
+  includedirs { "src", "third_party/include" }
+  files {
+    "src/tools/*.hpp", "src/tools/*.cpp",
+    "src/lucytypes.hpp", "src/utils.hpp", "src/utils.cpp",
+    "src/gen_vec.hpp", "src/gen_vec.cpp",
+    "src/gameplay.hpp", "src/gameplay.cpp",
+    "src/level_parser.hpp", "src/level_parser.cpp",
+    -- for the anims tool. header only DirectXMath, nothing gets drawn
+    "src/entity.hpp", "src/entity.cpp",
+    "src/animation.hpp", "src/animation.cpp",
+    "src/timer.hpp", "src/timer.cpp",
+  }
+  links { "user32.lib" }
+  buildoptions { "/W4", "/sdl", "/MP", "/std:c++20", "/EHsc", "/wd4100" }
+  -- the tools always run the full level sanity checks, see SanityChecks in gameplay.hpp
+  defines { "PSYCHOBOX_SANITY_FULL" }
+
+  filter "configurations:Debug"
+    targetdir "bin/Debug"
+    buildoptions { "/MDd" }
+    defines { "_DEBUG" }
+    symbols "On"
+
+  filter "configurations:Release or ReleaseChecked"
+    targetdir "bin/Release"
+    buildoptions { "/O2", "/MD" }
+    optimize "On"
@@ -2,88 +2,86 @@
 
 namespace {
 
-f32 tween_apply_ease(f32 t, EaseFunction ef) {
+// the ease curve on 4 ts at once. sin, cos, exp2 and sqrt are DirectXMath's vector versions (polynomial
+//  approximations for the first three), so there's no per lane powf / sinf call.
+XMVECTOR ease_v(XMVECTOR t, EaseFunction ef) {
 
     // more ease functions here
     //  https://easings.net/#
 
-    f32 t_f;
+    const XMVECTOR zero = XMVectorZero();
+    const XMVECTOR one = XMVectorReplicate(1.0f);
+    const XMVECTOR half = XMVectorReplicate(0.5f);
 
     // here u switch between tweening functions
     switch (ef) {
-    case EaseFunction::Linear: {
-        t_f = t;
-    } break;
+    case EaseFunction::Linear:
+        return t;
     case EaseFunction::CircOut: {
-        t_f = sqrtf(1.0f - powf(t - 1.0f, 2.0f));
-    } break;
+        XMVECTOR u = t - one;
+        return XMVectorSqrt(XMVectorMax(one - u * u, zero));
+    }
     case EaseFunction::CircInOut: {
-        if (t < 0.5f) {
-            t_f = (1.0f - sqrtf(1.0f - powf(2.0f * t, 2.0f))) / 2.0f;
-        } else {
-            t_f = (sqrtf(1.0f - powf(-2.f * t + 2.0f, 2.0f)) + 1) / 2.0f;
-        }
-    } break;
-    case EaseFunction::SineOut: {
-        t_f = sin((t * math::Pi) / 2.f);
-    } break;
-    case EaseFunction::SineInOut: {
-        t_f = -(cosf(math::Pi * t) - 1.f) / 2.f;
-    } break;
+        XMVECTOR u_low = t * 2.0f;
+        XMVECTOR u_high = t * -2.0f + XMVectorReplicate(2.0f);
+
+        XMVECTOR low = (one - XMVectorSqrt(XMVectorMax(one - u_low * u_low, zero))) * half;
+        XMVECTOR high = (XMVectorSqrt(XMVectorMax(one - u_high * u_high, zero)) + one) * half;
+
+        return XMVectorSelect(high, low, XMVectorLess(t, half));
+    }
+    case EaseFunction::SineOut:
+        return XMVectorSin(t * (math::Pi / 2.0f));
+    case EaseFunction::SineInOut:
+        return (one - XMVectorCos(t * math::Pi)) * half;
     case EaseFunction::EaseOutBounce: {
         const f32 N1 = 7.5625f;
         const f32 D1 = 2.75f;
 
-        if (t < (1.0f / D1)) {
-            t_f = N1 * t * t;
-        } else if (t < (2.0f / D1)) {
-            f32 temp = t - (1.5f / D1);
-            t_f = N1 * temp * temp + 0.75f;
-        } else if (t < (2.5f / D1)) {
-            f32 temp = t - (2.25f / D1);
-            t_f = N1 * temp * temp + 0.9375f;
-        } else {
-            f32 temp = t - (2.625f / D1);
-            t_f = N1 * temp * temp + 0.984375f;
-        }
-    } break;
+        // every piece of the curve, then picking the one each t falls in
+        XMVECTOR u0 = t;
+        XMVECTOR u1 = t - XMVectorReplicate(1.5f / D1);
+        XMVECTOR u2 = t - XMVectorReplicate(2.25f / D1);
+        XMVECTOR u3 = t - XMVectorReplicate(2.625f / D1);
+
+        XMVECTOR res = u3 * u3 * N1 + XMVectorReplicate(0.984375f);
+        res = XMVectorSelect(res, u2 * u2 * N1 + XMVectorReplicate(0.9375f),
+                             XMVectorLess(t, XMVectorReplicate(2.5f / D1)));
+        res = XMVectorSelect(res, u1 * u1 * N1 + XMVectorReplicate(0.75f),
+                             XMVectorLess(t, XMVectorReplicate(2.0f / D1)));
+        res = XMVectorSelect(res, u0 * u0 * N1, XMVectorLess(t, XMVectorReplicate(1.0f / D1)));
+        return res;
+    }
     case EaseFunction::EaseOutElastic: {
         const f32 C4 = (2.0f * math::Pi) / 5.0f;
 
-        if (t < 0.0f) {
-            t_f = 0.0f;
-        } else if (t > 1.0f) {
-            t_f = 1.0f;
-        } else {
-            t_f = powf(2.0f, -10.0f * t) * sinf((t * 10.0f - 0.75f) * C4) + 1.0f;
-        }
-    } break;
-    default:
-        t_f = 0.0f;
+        XMVECTOR res = XMVectorExp2(t * -10.0f) * XMVectorSin((t * 10.0f - XMVectorReplicate(0.75f)) * C4) + one;
+        res = XMVectorSelect(res, zero, XMVectorLess(t, zero));
+        res = XMVectorSelect(res, one, XMVectorGreater(t, one));
+        return res;
+    }
+    case EaseFunction::Count:
         break;
     }
 
-    return t_f;
+    return zero;
 }
 
-v3 tween_v3(v3 start, v3 end, f32 t, EaseFunction ef) {
-    f32 t_f = tween_apply_ease(t, ef);
-
-    XMVECTOR v_s = XMLoadFloat3(&start);
-    XMVECTOR v_e = XMLoadFloat3(&end);
-
-    XMVECTOR v_res = v_s * (1.0f - t_f) + v_e * t_f;
-
-    v3 res;
+f32 tween_apply_ease(f32 t, EaseFunction ef) {
+    return XMVectorGetX(ease_v(XMVectorReplicate(t), ef));
+}
 
-    XMStoreFloat3(&res, v_res);
+// eases ts in place, 4 at a time. the size has to be a multiple of 4.
+void ease_batch(span<f32> ts, EaseFunction ef) {
+    lassert(ts.size() % 4 == 0);
 
-    return res;
+    for (u64 i = 0; i < ts.size(); i += 4) {
+        XMFLOAT4 *t4 = (XMFLOAT4 *)&ts[i];
+        XMStoreFloat4(t4, ease_v(XMLoadFloat4(t4), ef));
+    }
 }
 
-v4 tween_v4(v4 start, v4 end, f32 t, EaseFunction ef) {
-    f32 t_f = tween_apply_ease(t, ef);
-
+v4 lerp_v4(v4 start, v4 end, f32 t_f) {
     XMVECTOR v_s = XMLoadFloat4(&start);
     XMVECTOR v_e = XMLoadFloat4(&end);
 
@@ -96,165 +94,617 @@ v4 tween_v4(v4 start, v4 end, f32 t, EaseFunction ef) {
     return res;
 }
 
-f32 tween_f(f32 start, f32 end, f32 t, EaseFunction ef) {
-    f32 t_f = tween_apply_ease(t, ef);
-    return start * (1.0f - t_f) + end * t_f;
+// rotations are quaternions, slerp keeps them unit length and takes the short way around
+v4 slerp_quat(v4 start, v4 end, f32 t_f) {
+    XMVECTOR q_s = XMLoadFloat4(&start);
+    XMVECTOR q_e = XMLoadFloat4(&end);
+
+    v4 res;
+
+    XMStoreFloat4(&res, XMQuaternionSlerp(q_s, q_e, t_f));
+
+    return res;
 }
 
-void do_animation_tick(Animated &a, Entity &ent, bool fast_forward = false) {
+// the segment of a keyframe animation that t is in, and how far along that segment it is.
+//  an animation without keys is a single segment from prev to target.
+u32 anim_segment(const AnimationSystem &as, const Animated &a, f32 t, f32 &out_segment_t) {
+    if (a.key_count == 0) {
+        out_segment_t = t;
+        return 0;
+    }
 
-    f32 the_t = a.t;
+    const AnimKey *keys = &as.keys[a.key_begin];
+    f32 elapsed_s = t * a.duration_s;
+    u32 k = 0;
+    for (; k + 1 < a.key_count && elapsed_s > keys[k].duration_s; ++k) {
+        elapsed_s -= keys[k].duration_s;
+    }
 
-    if (fast_forward)
-        the_t = 1.0f;
+    f32 key_duration_s = keys[k].duration_s;
+    out_segment_t = key_duration_s > F32_EPSILON ? math::Min(math::Max(elapsed_s / key_duration_s, 0.0f), 1.0f)
+                                                 : 1.0f;
+    return k;
+}
+
+EaseFunction anim_segment_ease(const AnimationSystem &as, const Animated &a, u32 segment) {
+    return a.key_count == 0 ? a.ease_function : as.keys[a.key_begin + segment].ease_function;
+}
 
-    EaseFunction the_ease = a.ease_function;
+// writes the animated prop at the already eased t_f of the segment
+void anim_write(const AnimationSystem &as, const Animated &a, EntitySystem &es, u32 ent_i, u32 segment, f32 t_f) {
+    v4 from = segment == 0 ? a.ent.prev : as.keys[a.key_begin + segment - 1].value;
+    v4 to = a.key_count == 0 ? a.ent.target : as.keys[a.key_begin + segment].value;
 
     switch (a.ent.what) {
-    case EntityProp::Position: {
-        v4 new_val = tween_v4(a.ent.prev, a.ent.target, the_t, the_ease);
-        ent.box.pos = math::v4tov3(new_val);
-    } break;
-    case EntityProp::Scale: {
-        v4 new_val = tween_v4(a.ent.prev, a.ent.target, the_t, the_ease);
-        ent.box.scale = math::v4tov3(new_val);
-    } break;
-    case EntityProp::Color: {
-        v4 new_val = tween_v4(a.ent.prev, a.ent.target, the_t, the_ease);
-        ent.box.color = new_val;
-    } break;
-    case EntityProp::Rotation: {
-        v3 new_axis = tween_v3(math::v4tov3(a.ent.prev), math::v4tov3(a.ent.target), the_t, the_ease);
-        f32 new_angle = tween_f(a.ent.prev.w, a.ent.target.w, the_t, the_ease);
-        ent.box.rot = v4(new_axis.x, new_axis.y, new_axis.z, new_angle);
-    } break;
-    }
-}
-
-bool handle_anim_conflict(vec<Animated>::iterator &it, vec<Animated> &anims, EntitySystem &es, Animated &a) {
-
-    for (auto next_it = it + 1; next_it != anims.end(); ++next_it) {
-        const Animated &anim_next = *next_it;
-
-        bool targets_same_entity = anim_next.the_thing == AnimatedThing::Entity &&
-                                   genkey_eq(a.ent.entity_id, anim_next.ent.entity_id) &&
-                                   a.ent.what == anim_next.ent.what;
-
-        if (!targets_same_entity)
-            continue;
+    case EntityProp::Position:
+        es.set_pos(ent_i, math::v4tov3(lerp_v4(from, to, t_f)));
+        break;
+    case EntityProp::Scale:
+        es.set_scale(ent_i, math::v4tov3(lerp_v4(from, to, t_f)));
+        break;
+    case EntityProp::Color:
+        es.set_color(ent_i, lerp_v4(from, to, t_f));
+        break;
+    case EntityProp::Rotation:
+        es.set_rot(ent_i, slerp_quat(from, to, t_f));
+        break;
+    case EntityProp::Count:
+        break;
+    }
+}
 
-        switch (anim_next.conflict_resolution) {
-        case AnimationConflictResolution::KillOthers: {
-            // Found a future animation that should kill all others. so, this animation is killed.
-            it = anims.erase(it);
-            return true;
-        } break;
-        case AnimationConflictResolution::FastForwardOthers: {
-            // Found a future animation that should fast forward all ohers. so, this animation is fast forwarded,
-            // and killed.
+// writes the animated prop as it is at t = 1.0f
+void anim_write_end(const AnimationSystem &as, const Animated &a, EntitySystem &es, u32 ent_i) {
+    f32 segment_t;
+    u32 segment = anim_segment(as, a, 1.0f, segment_t);
+    anim_write(as, a, es, ent_i, segment, tween_apply_ease(segment_t, anim_segment_ease(as, a, segment)));
+}
 
-            // only fast forward animations that don't have this conflict resolution
-            if (a.conflict_resolution == AnimationConflictResolution::FastForwardOthers)
-                continue;
+// writes a float channel and its dest right away, outside of the tick's batch
+void float_write(AnimationSystem &as, GenKey channel, f32 value) {
+    u32 f_i = as.float_table.find(channel);
+    if (f_i != SLOT_NONE) {
+        as.float_values[f_i] = value;
+        *as.float_dests[f_i] = value;
+    }
+}
 
-            Entity *ent = es.get(a.ent.entity_id);
-            if (!ent) {
-                it = anims.erase(it);
-                return true;
-            }
+Animated &anim_at(AnimationSystem &as, u32 ref) {
+    return (ref & ANIM_PENDING) ? as.pending[ref & ~ANIM_PENDING] : as.anims[ref];
+}
 
-            do_animation_tick(a, *ent, true);
-            it = anims.erase(it);
-            return true;
+const Animated &anim_at(const AnimationSystem &as, u32 ref) {
+    return (ref & ANIM_PENDING) ? as.pending[ref & ~ANIM_PENDING] : as.anims[ref];
+}
 
-        } break;
+AnimTrack &track_of(AnimationSystem &as, GenKey entity_id, EntityProp what) {
+    if (entity_id.index >= as.tracks.size()) {
+        array<AnimTrack, (u32)EntityProp::Count> empty_tracks;
+        empty_tracks.fill(AnimTrack{SLOT_NONE, SLOT_NONE, SLOT_NONE});
+        as.tracks.resize(entity_id.index + 1, empty_tracks);
+    }
+    return as.tracks[entity_id.index][(u32)what];
+}
+
+// the entity or the float channel the animation writes
+GenKey anim_target_key(const Animated &a) {
+    return a.the_thing == AnimatedThing::Float ? a.simple.channel : a.ent.entity_id;
+}
+
+AnimTrack &track_of_anim(AnimationSystem &as, const Animated &a) {
+    if (a.the_thing == AnimatedThing::Entity) {
+        return track_of(as, a.ent.entity_id, a.ent.what);
+    }
+
+    if (a.simple.channel.index >= as.float_tracks.size()) {
+        as.float_tracks.resize(a.simple.channel.index + 1, AnimTrack{SLOT_NONE, SLOT_NONE, SLOT_NONE});
+    }
+    return as.float_tracks[a.simple.channel.index];
+}
+
+// takes the animation at ref out of its track
+void track_unlink(AnimationSystem &as, u32 ref) {
+    const Animated &a = anim_at(as, ref);
+    AnimTrack &track = track_of_anim(as, a);
+
+    if (a.track_prev != SLOT_NONE) {
+        anim_at(as, a.track_prev).track_next = a.track_next;
+    } else {
+        track.first = a.track_next;
+    }
+
+    if (a.track_next != SLOT_NONE) {
+        anim_at(as, a.track_next).track_prev = a.track_prev;
+    } else {
+        track.last = a.track_prev;
+    }
+
+    // the next newest running one is the first running one before it
+    if (track.newest_running == ref) {
+        u32 older = a.track_prev;
+        while (older != SLOT_NONE && (older & ANIM_PENDING)) {
+            older = anim_at(as, older).track_prev;
+        }
+        track.newest_running = older;
+    }
+}
+
+// points the track of the animation now at ref to ref, after it was moved there
+void track_relink(AnimationSystem &as, u32 ref) {
+    const Animated &a = anim_at(as, ref);
+    AnimTrack &track = track_of_anim(as, a);
+
+    if (a.track_prev != SLOT_NONE) {
+        anim_at(as, a.track_prev).track_next = ref;
+    } else {
+        track.first = ref;
+    }
+
+    if (a.track_next != SLOT_NONE) {
+        anim_at(as, a.track_next).track_prev = ref;
+    } else {
+        track.last = ref;
+    }
+}
+
+// every move goes through here, one at a time, so the track links stay right
+void anim_move(AnimationSystem &as, u32 from, u32 to) {
+    anim_at(as, to) = anim_at(as, from);
+    track_relink(as, to);
+
+    // pending ones are never the newest running
+    if (!(from & ANIM_PENDING)) {
+        AnimTrack &track = track_of_anim(as, anim_at(as, to));
+        if (track.newest_running == from) {
+            track.newest_running = to;
         }
     }
+}
+
+// swaps two pending animations through a spare slot at the end
+void pending_swap(AnimationSystem &as, u32 i, u32 j) {
+    u32 spare = (u32)as.pending.size();
+    as.pending.push_back(as.pending[i]);
+    track_relink(as, spare | ANIM_PENDING);
+
+    anim_move(as, j | ANIM_PENDING, i | ANIM_PENDING);
+    anim_move(as, spare | ANIM_PENDING, j | ANIM_PENDING);
 
-    return false;
+    as.pending.pop_back();
+}
+
+void pending_sift_up(AnimationSystem &as, u32 i) {
+    while (i > 0) {
+        u32 parent = (i - 1) / 2;
+        if (as.pending[parent].start_s <= as.pending[i].start_s) {
+            break;
+        }
+        pending_swap(as, i, parent);
+        i = parent;
+    }
+}
+
+void pending_sift_down(AnimationSystem &as, u32 i) {
+    u32 count = (u32)as.pending.size();
+
+    for (;;) {
+        u32 smallest = i;
+        u32 l = i * 2 + 1;
+        u32 r = l + 1;
+
+        if (l < count && as.pending[l].start_s < as.pending[smallest].start_s) {
+            smallest = l;
+        }
+        if (r < count && as.pending[r].start_s < as.pending[smallest].start_s) {
+            smallest = r;
+        }
+        if (smallest == i) {
+            break;
+        }
+
+        pending_swap(as, i, smallest);
+        i = smallest;
+    }
+}
+
+// fills the hole at pending slot i, whose animation was already unlinked or moved out, with the last one
+void pending_fill_hole(AnimationSystem &as, u32 i) {
+    u32 last = (u32)as.pending.size() - 1;
+    if (i != last) {
+        anim_move(as, last | ANIM_PENDING, i | ANIM_PENDING);
+    }
+    as.pending.pop_back();
+
+    if (i < as.pending.size()) {
+        pending_sift_up(as, i);
+        pending_sift_down(as, i);
+    }
+}
+
+// a free block of ANIM_MAX_KEYS keys, its key_begin
+u32 key_block_take(AnimationSystem &as) {
+    if (as.free_key_blocks.size() > 0) {
+        u32 key_begin = as.free_key_blocks.back();
+        as.free_key_blocks.pop_back();
+        return key_begin;
+    }
+
+    u32 key_begin = (u32)as.keys.size();
+    as.keys.resize(as.keys.size() + ANIM_MAX_KEYS);
+    as.key_block_added.push_back(0);
+    return key_begin;
+}
+
+// swap remove from the running animations, the last one ends up at ref. pending ones leave the heap.
+void anim_remove(AnimationSystem &as, u32 ref) {
+    track_unlink(as, ref);
+    ++as.stats.removed;
+
+    if (anim_at(as, ref).key_count > 0) {
+        u32 key_begin = anim_at(as, ref).key_begin;
+        as.key_block_added[key_begin / ANIM_MAX_KEYS] = 0;
+        as.free_key_blocks.push_back(key_begin);
+    }
+
+    if (ref & ANIM_PENDING) {
+        pending_fill_hole(as, ref & ~ANIM_PENDING);
+        return;
+    }
+
+    u32 last = (u32)as.anims.size() - 1;
+    if (ref != last) {
+        anim_move(as, last, ref);
+    }
+    as.anims.pop_back();
+}
+
+// a newer animation on the same track that's already running overwrites whatever the running one at ref writes
+bool anim_is_shadowed(AnimationSystem &as, u32 ref) {
+    // the newest on its track usually, which is also the newest running one
+    const Animated &a = as.anims[ref];
+    return a.track_next != SLOT_NONE && track_of_anim(as, a).newest_running != ref;
+}
+
+// moves the animations whose delay ran out from the heap to the running ones
+void anims_start_pending(AnimationSystem &as) {
+    while (as.pending.size() > 0 && as.pending[0].start_s - as.now_s <= F32_EPSILON) {
+        u32 ref = (u32)as.anims.size();
+        as.anims.push_back(as.pending[0]);
+        track_relink(as, ref);
+
+        // a delayed animation can start after a newer one that had no delay, that one keeps writing
+        const Animated &a = as.anims[ref];
+        AnimTrack &track = track_of_anim(as, a);
+        if (track.newest_running == SLOT_NONE ||
+            (i32)(a.track_order - as.anims[track.newest_running].track_order) > 0) {
+            track.newest_running = ref;
+        }
+
+        pending_fill_hole(as, 0);
+        ++as.stats.started;
+    }
 }
 
 } // namespace
 
 // --------------------------------- EXPORTED FUNCTIONS (START) ---------------------------------
 
-void anims_tick(AnimationSystem &as, EntitySystem &es, f32 dt_sec) {
-    auto it = as.begin();
+GenKey anims_float_add(AnimationSystem &as, f32 *dest) {
+    GenKey res = as.float_table.add();
+    as.float_values.push_back(*dest);
+    as.float_dests.push_back(dest);
+    return res;
+}
+
+void anims_float_remove(AnimationSystem &as, GenKey channel) {
+    u32 hole, last;
+    if (!as.float_table.remove(channel, hole, last)) {
+        return;
+    }
+
+    if (hole != last) {
+        as.float_values[hole] = as.float_values[last];
+        as.float_dests[hole] = as.float_dests[last];
+    }
+    as.float_values.pop_back();
+    as.float_dests.pop_back();
+}
+
+void anim_add_key(AnimationSystem &as, Animated &a, v4 value, f32 duration_s, EaseFunction ef) {
+    lassert(a.key_count < ANIM_MAX_KEYS);
 
-    while (it != as.end()) {
-        auto &a = *it;
+    if (a.key_count == 0) {
+        a.duration_s = 0.0f;
 
-        bool anim_done = false;
+        a.key_begin = key_block_take(as);
+    }
+
+    as.keys[a.key_begin + a.key_count++] = AnimKey{value, duration_s, ef};
+    a.ent.target = value;
+    a.duration_s += duration_s;
+}
+
+void anims_add(AnimationSystem &as, EntitySystem &es, const Animated &a_in) {
+    Animated a = a_in;
+    a.track_prev = SLOT_NONE;
+    a.track_next = SLOT_NONE;
+    ++as.stats.added;
+    a.track_order = (u32)as.stats.added;
+
+    // not yet started animations wait in the heap
+    bool is_pending = a.delay_s > F32_EPSILON;
+    a.start_s = as.now_s + (is_pending ? a.delay_s : 0.0f);
+
+    GenKey key = anim_target_key(a);
+
+    // the same keyframe animation added twice would share its keys, and the second removal would free them again
+    if (a.key_count > 0) {
+        if (as.key_block_added[a.key_begin / ANIM_MAX_KEYS]) {
+            u32 key_begin = key_block_take(as);
+            for (u32 k = 0; k < a.key_count; ++k) {
+                as.keys[key_begin + k] = as.keys[a.key_begin + k];
+            }
+            a.key_begin = key_begin;
+        }
+        as.key_block_added[a.key_begin / ANIM_MAX_KEYS] = 1;
+    }
 
-        a.delay_s -= dt_sec;
-        if (a.delay_s > F32_EPSILON) {
-            ++it;
+    // going through the older animations on the track. the ones of an entity or float channel that used to
+    //  be in this slot are dropped too, the tick would drop them anyway. removing moves other animations
+    //  around, so the walk starts over from the track's first after each removal.
+    u32 ref = track_of_anim(as, a).first;
+    while (ref != SLOT_NONE) {
+        Animated &other = anim_at(as, ref);
+
+        bool is_stale = !genkey_eq(anim_target_key(other), key);
+        bool remove = is_stale;
+
+        switch (a.conflict_resolution) {
+        case AnimationConflictResolution::DoNothing:
+            break;
+        case AnimationConflictResolution::KillOthers:
+            remove = true;
+            break;
+        case AnimationConflictResolution::FastForwardOthers: {
+            // animations that fast forward others don't get fast forwarded themselves
+            if (other.conflict_resolution == AnimationConflictResolution::FastForwardOthers) {
+                break;
+            }
+
+            if (!is_stale && other.the_thing == AnimatedThing::Float) {
+                float_write(as, key, other.simple.target);
+            } else if (!is_stale) {
+                u32 ent_i = es.find(key);
+                if (ent_i != SLOT_NONE) {
+                    anim_write_end(as, other, es, ent_i);
+                }
+            }
+            remove = true;
+        } break;
+        }
+
+        if (!remove) {
+            ref = other.track_next;
             continue;
         }
 
-        a.t += dt_sec / a.duration_s;
-        if (a.t > 1.0f) {
-            a.t = 1.0f;
-            anim_done = true;
+        anim_remove(as, ref);
+        if (!is_stale) {
+            ++as.stats.conflicts_resolved;
         }
+        ref = track_of_anim(as, a).first;
+    }
 
-        switch (a.the_thing) {
-        case AnimatedThing::Entity: {
-            // delete animation if there's another animation targeting the same
-            //   entity and the thing to animate later on
+    u32 new_ref = is_pending ? (u32)as.pending.size() | ANIM_PENDING : (u32)as.anims.size();
+    AnimTrack &track = track_of_anim(as, a);
 
-            bool should_continue = handle_anim_conflict(it, as, es, a);
+    a.track_prev = track.last;
+    if (track.last != SLOT_NONE) {
+        anim_at(as, track.last).track_next = new_ref;
+    } else {
+        track.first = new_ref;
+    }
+    track.last = new_ref;
+    if (!is_pending) {
+        track.newest_running = new_ref;
+    }
 
-            if (should_continue) {
-                continue;
+    if (is_pending) {
+        as.pending.push_back(a);
+        pending_sift_up(as, (u32)as.pending.size() - 1);
+    } else {
+        as.anims.push_back(a);
+    }
+}
+
+void anims_kill(AnimationSystem &as, GenKey entity_id, EntityProp what) {
+    if (entity_id.index >= as.tracks.size()) {
+        return;
+    }
+
+    while (as.tracks[entity_id.index][(u32)what].last != SLOT_NONE) {
+        anim_remove(as, as.tracks[entity_id.index][(u32)what].last);
+    }
+}
+
+void anims_finish(AnimationSystem &as, EntitySystem &es, span<const GenKey> entity_ids) {
+    for (GenKey key : entity_ids) {
+        if (key.index >= as.tracks.size()) {
+            continue;
+        }
+
+        u32 ent_i = es.find(key);
+
+        for (u32 what = 0; what < (u32)EntityProp::Count; ++what) {
+            // oldest first, so the end of the newest one is what stays
+            for (u32 ref = as.tracks[key.index][what].first; ref != SLOT_NONE; ref = anim_at(as, ref).track_next) {
+                const Animated &a = anim_at(as, ref);
+                if (ent_i != SLOT_NONE && genkey_eq(a.ent.entity_id, key)) {
+                    anim_write_end(as, a, es, ent_i);
+                    ++as.stats.finished_early;
+                }
             }
 
-            // delete animation if the entity is not found
-            Entity *ent = es.get(a.ent.entity_id);
-            if (!ent) {
-                it = as.erase(it);
+            anims_kill(as, key, (EntityProp)what);
+        }
+    }
+}
+
+void anims_write_ends(AnimationSystem &as, EntitySystem &es) {
+    for (const vec<Animated> *list : {&as.anims, &as.pending}) {
+        for (const auto &a : *list) {
+            // the newest animation of a track is where its prop ends up
+            if (a.the_thing != AnimatedThing::Entity || a.track_next != SLOT_NONE) {
                 continue;
             }
 
-            do_animation_tick(a, *ent);
-        } break;
-        case AnimatedThing::Float: {
-            *a.simple.the_float = tween_f(a.simple.prev, a.simple.target, a.t, a.ease_function);
-        } break;
+            u32 ent_i = es.find(a.ent.entity_id);
+            if (ent_i != SLOT_NONE) {
+                anim_write_end(as, a, es, ent_i);
+                ++as.stats.finished_early;
+            }
         }
+    }
+}
+
+void anims_clear(AnimationSystem &as) {
+    as.anims.clear();
+    as.pending.clear();
+    as.tracks.clear();
+    as.float_tracks.clear();
+    as.keys.clear();
+    as.free_key_blocks.clear();
+    as.key_block_added.clear();
+    as.now_s = 0.0;
+}
+
+void anims_reserve(AnimationSystem &as, u32 anim_count, u32 entity_count) {
+    as.anims.reserve(anim_count);
+    // + 1 for the spare slot pending_swap goes through
+    as.pending.reserve(anim_count + 1);
+    as.tracks.reserve(entity_count);
+    // a keyframed animation or so per entity, like the win ripple
+    as.keys.reserve((u64)entity_count * ANIM_MAX_KEYS);
+    as.free_key_blocks.reserve(entity_count);
+    as.key_block_added.reserve(entity_count);
+    as.tick_keys.reserve(anim_count);
+    as.tick_ents.reserve(anim_count);
+}
 
-        if (anim_done) {
-            it = as.erase(it);
-        } else {
-            ++it;
+void anims_tick(AnimationSystem &as, EntitySystem &es, f32 dt_sec) {
+    auto &anims = as.anims;
+    auto &ents = as.tick_ents;
+
+    // an animation starting this tick already moves by dt_sec, like it would have when it counted its
+    //  delay down itself
+    as.now_s += dt_sec;
+    anims_start_pending(as);
+
+    // resolving every entity handle in one batch. nothing here adds or removes entities,
+    //  so the pointers stay good for the whole tick.
+    as.tick_keys.assign(anims.size(), GenKey{});
+    ents.resize(anims.size());
+    for (u64 i = 0; i < anims.size(); ++i) {
+        if (anims[i].the_thing == AnimatedThing::Entity) {
+            as.tick_keys[i] = anims[i].ent.entity_id;
+        }
+    }
+
+    es.table.find_many(as.tick_keys, ents);
+
+    for (u64 i = 0; i < anims.size(); ++i) {
+        if (anims[i].the_thing == AnimatedThing::Float) {
+            ents[i] = as.float_table.find(anims[i].simple.channel);
         }
     }
-}
 
-// looks up if there's an animation targeting the entity's position, and returns the position at t = 1.0f
-//  it will take the LAST animation in the queue targeting this.
-//  if there's no animation, it returns the current position
-// v3 anims_get_future_pos(App &app, GenKey entity_id) {
-v3 anims_get_future_pos(AnimationSystem &as, EntitySystem &es, GenKey entity_id) {
+    for (auto &a : anims) {
+        a.t = math::Min(a.t + dt_sec / a.duration_s, 1.0f);
+    }
 
-    bool anim_found = false;
-    Animated *the_anim = 0;
+    // the animations that write something this tick, by the ease function of the segment they're in
+    for (auto &group : as.ease_groups) {
+        group.clear();
+    }
 
-    for (Animated &a : as) {
-        bool found = a.the_thing == AnimatedThing::Entity && genkey_eq(a.ent.entity_id, entity_id) &&
-                     a.ent.what == EntityProp::Position;
+    for (u64 i = 0; i < anims.size(); ++i) {
+        const auto &a = anims[i];
 
-        if (found) {
-            anim_found = true;
-            the_anim = &a;
+        if (ents[i] == SLOT_NONE || anim_is_shadowed(as, (u32)i)) {
+            continue;
         }
+
+        f32 segment_t;
+        u32 segment = anim_segment(as, a, a.t, segment_t);
+        as.ease_groups[(u32)anim_segment_ease(as, a, segment)].push_back((u32)i);
     }
 
-    if (anim_found) {
-        return math::v4tov3(the_anim->ent.target);
-    } else {
-        Entity *ent = es.get(entity_id);
-        lassert(ent);
-        return ent->box.pos;
+    // easing every group's ts in one go, then writing the props
+    as.tick_floats.clear();
+    as.stats.written_last_tick = 0;
+    for (u32 ef = 0; ef < (u32)EaseFunction::Count; ++ef) {
+        const auto &group = as.ease_groups[ef];
+        if (group.empty()) {
+            continue;
+        }
+
+        // padded to a multiple of 4 for ease_batch
+        as.ease_ts.resize((group.size() + 3) & ~(u64)3);
+        for (u64 j = 0; j < group.size(); ++j) {
+            const auto &a = anims[group[j]];
+            anim_segment(as, a, a.t, as.ease_ts[j]);
+        }
+
+        ease_batch(as.ease_ts, (EaseFunction)ef);
+        as.stats.written_last_tick += (u32)group.size();
+
+        for (u64 j = 0; j < group.size(); ++j) {
+            const auto &a = anims[group[j]];
+            f32 t_f = as.ease_ts[j];
+
+            switch (a.the_thing) {
+            case AnimatedThing::Entity: {
+                f32 segment_t;
+                anim_write(as, a, es, ents[group[j]], anim_segment(as, a, a.t, segment_t), t_f);
+            } break;
+            case AnimatedThing::Float:
+                as.float_values[ents[group[j]]] = a.simple.prev * (1.0f - t_f) + a.simple.target * t_f;
+                as.tick_floats.push_back(ents[group[j]]);
+                break;
+            }
+        }
     }
+
+    for (u32 f_i : as.tick_floats) {
+        *as.float_dests[f_i] = as.float_values[f_i];
+    }
+
+    // dropping finished animations and the ones whose entity or float is gone. backwards, so what gets swapped
+    //  into a hole was already looked at and ents still lines up with everything before it.
+    for (u64 i = anims.size(); i-- > 0;) {
+        const auto &a = anims[i];
+
+        if (a.t >= 1.0f || ents[i] == SLOT_NONE) {
+            anim_remove(as, (u32)i);
+        }
+    }
+}
+
+// the target of the newest animation on the entity's position, which is where it ends up once every queued
+//  animation played. the track's last is kept up to date by anims_add and by every removal, so this doesn't
+//  look at any other animation. with no animation left, the last one already wrote its target, so it
+//  returns the current position.
+v3 anims_get_future_pos(const AnimationSystem &as, const EntitySystem &es, GenKey entity_id) {
+    if (entity_id.index < as.tracks.size()) {
+        u32 last = as.tracks[entity_id.index][(u32)EntityProp::Position].last;
+
+        if (last != SLOT_NONE && genkey_eq(anim_at(as, last).ent.entity_id, entity_id)) {
+            return math::v4tov3(anim_at(as, last).ent.target);
+        }
+    }
+
+    u32 ent_i = es.find(entity_id);
+    lassert(ent_i != SLOT_NONE);
+    return es.pos[ent_i];
 }
@@ -5,7 +5,7 @@
 
 enum struct EaseFunction { Linear, CircOut, CircInOut, SineOut, SineInOut, EaseOutBounce, EaseOutElastic, Count };
 
-enum struct EntityProp { Position, Scale, Color, Rotation };
+enum struct EntityProp { Position, Scale, Color, Rotation, Count };
 enum struct AnimatedThing { Entity, Float };
 
 // Determines how to handle other animations on the same entity that are in the queue
@@ -17,10 +17,19 @@ enum struct AnimationConflictResolution {
     FastForwardOthers,
 };
 
+// a point of a keyframe animation, reached duration_s after the key before it (or after prev for the first),
+//  eased with the key's own ease function on the way
+struct AnimKey {
+    v4 value;
+    f32 duration_s;
+    EaseFunction ease_function;
+};
+
+inline constexpr u32 ANIM_MAX_KEYS = 4;
+
 struct Animated {
-    // making it float4 so it can animate pos, scale, rot,
-    //   and also color. the fourth component will be ignored when it's not
-    //   color
+    // making it float4 so it can animate pos, scale, rot (a quaternion, slerped),
+    //   and also color. the fourth component will be ignored for pos and scale
     union {
         struct {
             v4 prev;
@@ -29,7 +38,8 @@ struct Animated {
             GenKey entity_id;
         } ent;
         struct {
-            f32 *the_float;
+            // from anims_float_add
+            GenKey channel;
             f32 prev;
             f32 target;
         } simple;
@@ -41,9 +51,102 @@ struct Animated {
     f32 duration_s;
     AnimationConflictResolution conflict_resolution = AnimationConflictResolution::KillOthers;
     EaseFunction ease_function = EaseFunction::SineInOut;
+
+    // entity animations only. with keys, the animation goes prev -> key 0 -> ... -> key key_count - 1, each
+    //  segment eased on its own. ease_function is unused then. the keys are AnimationSystem::keys from
+    //  key_begin, so a plain prev -> target tween doesn't carry any.
+    u32 key_begin;
+    u32 key_count;
+
+    // AnimationSystem::now_s the animation starts at, set by anims_add from delay_s
+    f64 start_s;
+
+    // the older and newer animations on the same entity and prop, or float channel, set by anims_add
+    u32 track_prev;
+    u32 track_next;
+    // when it was added, for telling which of two animations on a track is newer without walking it
+    u32 track_order;
+};
+
+// track links and AnimTrack point either into AnimationSystem::anims, or into AnimationSystem::pending
+//  with this bit set
+inline constexpr u32 ANIM_PENDING = 0x80000000;
+
+// oldest and newest animation on an entity's prop or a float channel, SLOT_NONE when there's none
+struct AnimTrack {
+    u32 first;
+    u32 last;
+    // the newest one that's running, the only one that writes. SLOT_NONE while they're all pending.
+    u32 newest_running;
+};
+
+// running totals since the start, for the debug ui and the anims tool. anims.size() and pending.size() are
+//  the active and the delayed but not yet started animations.
+struct AnimStats {
+    u64 added;
+    u64 conflicts_resolved; // older animations killed or fast forwarded by a newer one
+    u64 removed; // finished, resolved as a conflict, killed, or dropped with their entity
+    u64 started; // delays that ran out
+    u64 finished_early; // played to their end right away by anims_finish or anims_write_ends
+    u32 written_last_tick; // animations that wrote something in the last tick, the others were shadowed
 };
 
-using AnimationSystem = vec<Animated>;
+// Animations are packed in no particular order, so finished ones are swap removed. The ones still waiting
+//  for their delay sit in a min heap on start_s instead, so a tick only looks at what has started.
+// Animations are also linked per (entity, prop) and per float channel in the order they were added, which
+//  resolves conflicts when an animation is added instead of every tick, and lets only the newest running
+//  animation of a track write the prop.
+struct AnimationSystem {
+    vec<Animated> anims;
+    vec<Animated> pending;
+    // seconds ticked since the last anims_clear
+    f64 now_s;
+    AnimStats stats;
+    // by entity slot (GenKey::index), then by EntityProp
+    vec<array<AnimTrack, (u32)EntityProp::Count>> tracks;
+    // by float channel slot (GenKey::index)
+    vec<AnimTrack> float_tracks;
+
+    // keyframes, in blocks of ANIM_MAX_KEYS. a block belongs to an animation from its first anim_add_key until
+    //  the animation is removed.
+    vec<AnimKey> keys;
+    vec<u32> free_key_blocks; // the key_begin of blocks given back
+    vec<u8> key_block_added; // by block, whether an animation that went through anims_add owns it
+
+    // floats animations can target, packed. each one is copied to its dest after a tick that animated it.
+    SlotTable float_table;
+    vec<f32> float_values;
+    vec<f32 *> float_dests;
+
+    // anims_tick scratch, kept around so ticking doesn't allocate
+    vec<GenKey> tick_keys;
+    // the entity, or the float channel, each animation writes
+    vec<u32> tick_ents;
+    vec<u32> tick_floats;
+    // the animations that write this tick, grouped so each ease curve is evaluated 4 ts at a time
+    array<vec<u32>, (u32)EaseFunction::Count> ease_groups;
+    vec<f32> ease_ts;
+};
 
-v3 anims_get_future_pos(AnimationSystem &as, EntitySystem &es, GenKey entity_id);
+// registers a float for animations to target. the system owns its value, dest only gets a copy after
+//  every tick that animates it, so dest has to outlive the channel.
+GenKey anims_float_add(AnimationSystem &as, f32 *dest);
+void anims_float_remove(AnimationSystem &as, GenKey channel);
+// appends a key to a keyframe animation, moving its target and duration_s along. the first key takes a block
+//  of AnimationSystem::keys, so the animation has to go to anims_add afterwards. adding it again right after
+//  is fine, the copy gets keys of its own.
+void anim_add_key(AnimationSystem &as, Animated &a, v4 value, f32 duration_s, EaseFunction ef);
+// resolves a's conflict_resolution against the animations already on its entity and prop, then adds it
+void anims_add(AnimationSystem &as, EntitySystem &es, const Animated &a);
+// removes every animation on the entity's prop, without finishing them
+void anims_kill(AnimationSystem &as, GenKey entity_id, EntityProp what);
+// plays every animation on the entities, running or still delayed, to its end right away and removes it
+void anims_finish(AnimationSystem &as, EntitySystem &es, span<const GenKey> entity_ids);
+// writes where every entity animation, running or still delayed, ends up. the newest one on a prop wins. nothing
+//  gets removed, anims_clear after it drops them.
+void anims_write_ends(AnimationSystem &as, EntitySystem &es);
+void anims_clear(AnimationSystem &as);
+void anims_reserve(AnimationSystem &as, u32 anim_count, u32 entity_count);
+// where the entity ends up once its queued position animations played, without scanning them
+v3 anims_get_future_pos(const AnimationSystem &as, const EntitySystem &es, GenKey entity_id);
 void anims_tick(AnimationSystem &as, EntitySystem &es, f32 dt_sec);
\ No newline at end of file
@@ -12,6 +12,8 @@
 
 #include "debug_gui.hpp"
 
+#include <algorithm>
+
 namespace {
 
 const f32 unit_length = 1.0f;
@@ -19,6 +21,8 @@ const f32 level_transition_add = unit_length * 16.0f;
 const f32 cam_rot_duration = 0.3f;
 
 const f32 move_anim_duration = 0.1f;
+// duration of each step when walking a path
+const f32 walk_step_duration = 0.06f;
 
 // -- level transition consts --
 const f32 anchor_distance = 40.0f;
@@ -33,6 +37,11 @@ const v3 BOX_SCALE = v3(0.8f, 0.8f, 0.8f);
 const v4 FLOOR_COLOR = math::v4_one();
 const v3 FLOOR_SCALE = math::v3_one();
 
+// entities that can be alive on top of the ones a level is made of
+const u32 entity_pool_slack = 32;
+// longer frames (a hitch, a breakpoint) aren't caught up on, so there's no burst of steps after them
+const f32 sim_max_frame_s = 0.25f;
+
 v3 coord_to_v3(Coord c) {
     return v3(unit_length * c.x, -anchor_distance, unit_length * -c.y);
 }
@@ -72,22 +81,132 @@ void reset_cam_angle(App &app) {
 
     Animated a = {};
     a.the_thing = AnimatedThing::Float;
-    a.simple.the_float = &app.cam_controls.cam_y_angle;
+    a.simple.channel = app.cam_angle_anim;
     a.simple.prev = app.cam_controls.cam_y_angle;
     a.simple.target = app.current_angle;
     a.duration_s = cam_rot_duration;
-    app.as.push_back(a);
+    anims_add(app.as, app.es, a);
+}
+
+// the entity a tile entity is drawn as, in its resting state. returns false for tiles that don't have one.
+bool tile_entity_make(const TileEntity &te, Coord c, GenKey anchor_id, Entity &out_e) {
+    switch (te.tile) {
+    case Tile::Empty:
+        return false;
+    case Tile::Floor: {
+        Entity e = {};
+        e.box.pos = coord_to_v3(c);
+        e.box.color = FLOOR_COLOR;
+        e.box.scale = FLOOR_SCALE;
+        e.has_anchor = true;
+        e.anchor_id = anchor_id;
+        out_e = e;
+        return true;
+    }
+    case Tile::Wall: {
+        Entity e = {};
+        e.box.pos = coord_to_v3(c);
+        e.box.pos.y += get_elevation(e.box);
+        e.box.pos.y -= 0.25f;
+        e.box.scale.y = 0.5f;
+        e.has_anchor = true;
+        e.box.color = v4(0.24f, 0.08f, 0.24f, 0.8f);
+        e.anchor_id = anchor_id;
+        out_e = e;
+        return true;
+    }
+    case Tile::Player: {
+        Entity e = {};
+        e.box.kind = ShapeKind::BoxPlayer;
+        e.box.pos = coord_to_v3(c);
+        e.box.color = math::v4_red();
+        e.box.scale = v3(0.7f, 0.7f, 0.7f);
+        e.has_anchor = true;
+        e.anchor_id = anchor_id;
+        e.box.pos.y += get_elevation(e.box);
+        out_e = e;
+        return true;
+    }
+    case Tile::Box: {
+        Entity e = {};
+        e.box.pos = coord_to_v3(c);
+        e.box.color = BOX_COLOR;
+        e.box.scale = BOX_SCALE;
+        e.has_anchor = true;
+        e.anchor_id = anchor_id;
+        e.box.pos.y += get_elevation(e.box);
+        out_e = e;
+        return true;
+    }
+    case Tile::MirrorUL:
+    case Tile::MirrorUR:
+    case Tile::MirrorDL:
+    case Tile::MirrorDR: {
+        Entity e = {};
+        e.box.kind = ShapeKind::TriangularPrism;
+        e.box.pos = coord_to_v3(c);
+
+        f32 angle = 0.0f;
+        switch (te.tile) {
+        case Tile::MirrorUL:
+            angle = -math::Tau * 0.25f;
+            break;
+        case Tile::MirrorUR:
+            angle = 0.0f;
+            break;
+        case Tile::MirrorDL:
+            angle = math::Tau * 0.5f;
+            break;
+        case Tile::MirrorDR:
+            angle = math::Tau * 0.25f;
+            break;
+        }
+        e.box.rot = math::quat_from_axis_angle(v3(0.f, 1.f, 0.f), angle);
+
+        e.box.color = MIRROR_COLOR;
+        e.box.scale = v3(1.f, 1.f, 1.f);
+        e.has_anchor = true;
+        e.anchor_id = anchor_id;
+        e.box.pos.y += get_elevation(e.box);
+        out_e = e;
+        return true;
+    }
+    case Tile::Goal: {
+        Entity e = {};
+        e.box.kind = ShapeKind::Goal;
+        e.box.pos = coord_to_v3(c);
+        e.box.color = v4(1.f, 0.98f, 0.5f, 0.5f);
+        e.has_anchor = true;
+        e.anchor_id = anchor_id;
+        e.box.pos.y += get_elevation(e.box);
+        out_e = e;
+        return true;
+    }
+    }
+
+    return false;
 }
 
 // sets entities to reflect given level state
 void set_entities(App &app, Level &level, bool do_transition_anim) {
-    // clearing old level state
-    app.es.clear();
+#ifdef _DEBUG
+    u64 pool_capacity = app.es.pos.capacity();
+    u64 grid_chunks_capacity = app.grid.chunks.capacity();
+    u64 grid_index_capacity = app.grid.chunk_index.capacity();
+    u64 grid_occupied_capacity = app.grid.occupied.capacity();
+#endif
+
+    // clearing old level state. remove_all instead of clear so keys from the last level stay stale and
+    //  the memory reserved by app_reserve_pools is reused.
+    app.es.remove_all();
     timers_defer_clear(app.ts);
-    app.as.clear();
+    anims_clear(app.as);
+    app.move_anim_keys.clear();
     app.player_has_control = true;
     app.anchors.clear();
     app.preview_keys.clear();
+    app.clone_keys.clear();
+    app.walk_selecting = false;
 
     if (do_transition_anim) {
         app.current_angle = initial_cam_angle;
@@ -120,125 +239,166 @@ void set_entities(App &app, Level &level, bool do_transition_anim) {
         a.ent.what = EntityProp::Position;
         a.duration_s = transition_rot_duration;
         a.ease_function = level_rot_ease_function;
-        app.as.push_back(a);
+        anims_add(app.as, app.es, a);
     }
 
-    LevelPlane &lp = level.data[0];
+    level_for_each_cell(level, [&](Coord c, LevelCell &cell) {
+        for (auto &te : cell) {
+            Entity e = {};
+            if (!tile_entity_make(te, c, anchor_id, e)) {
+                continue;
+            }
+            te.has_entity = true;
+            te.entity_id = app.es.add(e);
+        }
+    });
 
-    for (u32 w = 0; w < level.width; ++w) {
-        for (u32 h = 0; h < level.height; ++h) {
+    app.grid.build(level);
 
-            auto &cell = lp[w][h];
+#ifdef _DEBUG
+    // app_reserve_pools sizes the pool and the grid for the biggest level
+    lassert(app.es.pos.capacity() == pool_capacity);
+    lassert(app.grid.chunks.capacity() == grid_chunks_capacity);
+    lassert(app.grid.chunk_index.capacity() == grid_index_capacity);
+    lassert(app.grid.occupied.capacity() == grid_occupied_capacity);
+#endif
+}
+
+bool shape_eq(const Shape &a, const Shape &b) {
+    return a.kind == b.kind && math::v3_eq(a.pos, b.pos) && math::v3_eq(a.scale, b.scale) &&
+           math::v4_eq(a.rot, b.rot) && math::v4_eq(a.color, b.color);
+}
+
+// brings the entities back in line with level after an undo. the undo replays the moves from level_start, whose
+//  tile entities set_entities gave their entities, so every tile entity still has its entity and only the cells
+//  the undone move changed need a look: moved entities slide back and the rest get their resting shape. what's
+//  still animating lands where it's headed first, and the previews, mirror clones and walk cursor go.
+void reconcile_entities(App &app, span<GameEvent> undone_events, const Level &level) {
+    // running animations and timers are from the state that's being left
+    anims_write_ends(app.as, app.es);
+    timers_defer_clear(app.ts);
+    anims_clear(app.as);
+    app.move_anim_keys.clear();
+    app.player_has_control = true;
+
+    for (auto k : app.preview_keys) {
+        app.es.remove(k);
+    }
+    app.preview_keys.clear();
+
+    for (auto k : app.clone_keys) {
+        app.es.remove(k);
+    }
+    app.clone_keys.clear();
+
+    if (app.walk_selecting) {
+        app.es.remove(app.walk_cursor_key);
+        app.walk_selecting = false;
+    }
 
-            if (cell_is_empty(cell)) {
+    lassert(app.anchors.size() > 0);
+    GenKey anchor_id = app.anchors[0];
+
+    for (auto anchor : app.anchors) {
+        u32 e_i = app.es.find(anchor);
+        lassert(e_i != SLOT_NONE);
+
+        if (!math::v3_eq(app.es.pos[e_i], anchor_pos)) {
+            app.es.set_pos(e_i, anchor_pos);
+        }
+    }
+
+    // the cells the undone move went from and to, once each
+    vec<Coord> &cells = app.undo_cells;
+    cells.clear();
+
+    for (const auto &ev : undone_events) {
+        if (ev.kind == EventKind::NormalMove || ev.kind == EventKind::BoxFall ||
+            ev.kind == EventKind::MirrorTeleport) {
+            cells.push_back(ev.from);
+            cells.push_back(ev.to);
+        }
+    }
+
+    const auto coord_less = [](Coord a, Coord b) { return a.x != b.x ? a.x < b.x : a.y < b.y; };
+    const auto coord_same = [](Coord a, Coord b) { return a.x == b.x && a.y == b.y; };
+    std::sort(cells.begin(), cells.end(), coord_less);
+    cells.erase(std::unique(cells.begin(), cells.end(), coord_same), cells.end());
+
+    for (Coord c : cells) {
+        for (const auto &te : level_cell(level, c)) {
+            Entity e = {};
+            if (!te.has_entity || !tile_entity_make(te, c, anchor_id, e)) {
                 continue;
             }
 
-            Coord c = {(i32)w, (i32)h};
-            const v3 def_pos = coord_to_v3(c);
-
-            for (auto &te : cell) {
-                switch (te.tile) {
-                case Tile::Empty:
-                    break;
-                case Tile::Floor: {
-                    Entity e = {};
-                    e.box.pos = def_pos;
-                    e.box.color = FLOOR_COLOR;
-                    e.box.scale = FLOOR_SCALE;
-                    e.has_anchor = true;
-                    e.anchor_id = anchor_id;
-                    GenKey k = app.es.add(e);
-                    te.has_entity = true;
-                    te.entity_id = k;
-                } break;
-                case Tile::Wall: {
-                    Entity e = {};
-                    e.box.pos = def_pos;
-                    e.box.pos.y += get_elevation(e.box);
-                    e.box.pos.y -= 0.25f;
-                    e.box.scale.y = 0.5f;
-                    e.has_anchor = true;
-                    e.box.color = v4(0.24f, 0.08f, 0.24f, 0.8f);
-                    e.anchor_id = anchor_id;
-                    GenKey k = app.es.add(e);
-                    te.has_entity = true;
-                    te.entity_id = k;
-                } break;
-                case Tile::Player: {
-                    Entity e = {};
-                    e.box.kind = ShapeKind::BoxPlayer;
-                    e.box.pos = def_pos;
-                    e.box.color = math::v4_red();
-                    e.box.scale = v3(0.7f, 0.7f, 0.7f);
-                    e.has_anchor = true;
-                    e.anchor_id = anchor_id;
-                    e.box.pos.y += get_elevation(e.box);
-                    GenKey k = app.es.add(e);
-                    te.has_entity = true;
-                    te.entity_id = k;
-                } break;
-                case Tile::Box: {
-                    Entity e = {};
-                    e.box.pos = def_pos;
-                    e.box.color = BOX_COLOR;
-                    e.box.scale = BOX_SCALE;
-                    e.has_anchor = true;
-                    e.anchor_id = anchor_id;
-                    e.box.pos.y += get_elevation(e.box);
-                    GenKey k = app.es.add(e);
-                    te.has_entity = true;
-                    te.entity_id = k;
-                } break;
-                case Tile::MirrorUL:
-                case Tile::MirrorUR:
-                case Tile::MirrorDL:
-                case Tile::MirrorDR: {
-                    Entity e = {};
-                    e.box.kind = ShapeKind::TriangularPrism;
-                    e.box.pos = def_pos;
-
-                    e.box.rot.y = 1.0;
-                    switch (te.tile) {
-                    case Tile::MirrorUL:
-                        e.box.rot.w = -math::Tau * 0.25f;
-                        break;
-                    case Tile::MirrorUR:
-                        e.box.rot.w = 0.0f;
-                        break;
-                    case Tile::MirrorDL:
-                        e.box.rot.w = math::Tau * 0.5f;
-                        break;
-                    case Tile::MirrorDR:
-                        e.box.rot.w = math::Tau * 0.25f;
-                        break;
-                    }
-
-                    e.box.color = MIRROR_COLOR;
-                    e.box.scale = v3(1.f, 1.f, 1.f);
-                    e.has_anchor = true;
-                    e.anchor_id = anchor_id;
-                    e.box.pos.y += get_elevation(e.box);
-                    GenKey k = app.es.add(e);
-                    te.has_entity = true;
-                    te.entity_id = k;
-                } break;
-                case Tile::Goal: {
-                    Entity e = {};
-                    e.box.kind = ShapeKind::Goal;
-                    e.box.pos = def_pos;
-                    e.box.color = v4(1.f, 0.98f, 0.5f, 0.5f);
-                    e.has_anchor = true;
-                    e.anchor_id = anchor_id;
-                    e.box.pos.y += get_elevation(e.box);
-                    GenKey k = app.es.add(e);
-                    te.has_entity = true;
-                    te.entity_id = k;
-                } break;
-                }
+            u32 e_i = app.es.find(te.entity_id);
+            if (e_i == SLOT_NONE) {
+                continue;
+            }
+
+            app.es.visible[e_i] = e.visible;
+
+            Shape shape_now = app.es.get_shape(e_i);
+            if (shape_eq(shape_now, e.box)) {
+                continue;
+            }
+
+            v3 pos_to = e.box.pos;
+            e.box.pos = shape_now.pos;
+            app.es.set_shape(e_i, e.box);
+
+            if (!math::v3_eq(shape_now.pos, pos_to)) {
+                Animated a = {};
+                a.ent.entity_id = te.entity_id;
+                a.ent.prev = math::v3tov4(shape_now.pos);
+                a.ent.target = math::v3tov4(pos_to);
+                a.ent.what = EntityProp::Position;
+                a.duration_s = move_anim_duration;
+                anims_add(app.as, app.es, a);
             }
         }
     }
+
+    app.grid.apply_events(level, undone_events);
+}
+
+// reserves the entity system, animations and grid for the biggest level, so switching levels only reuses memory
+void app_reserve_pools(App &app) {
+    u32 max_entities = 0;
+    u32 max_chunks = 0;
+    u32 max_chunk_slots = 0;
+
+    for (const auto &ln : app.levels) {
+        const Level &level = ln.level;
+        u32 entities = 0;
+
+        level_for_each_cell(level, [&entities](Coord, const LevelCell &cell) {
+            for (const auto &te : cell) {
+                entities += te.tile != Tile::Empty;
+            }
+        });
+
+        max_entities = math::Max(max_entities, entities);
+        max_chunks = math::Max(max_chunks, (u32)level.chunks.size());
+        max_chunk_slots = math::Max(max_chunk_slots, (u32)level.chunk_index.size());
+    }
+
+    // the anchor plus previews, mirror clones and the walk cursor
+    max_entities += entity_pool_slack;
+
+    app.es.reserve(max_entities);
+    app.clone_keys.reserve(entity_pool_slack);
+    // a few per entity: the win ripple, box falls with their color and scale, and the player and camera
+    anims_reserve(app.as, max_entities * 4, max_entities);
+    // mirror clones each wait on a timer to be deleted, and winning queues three
+    timers_reserve(app.ts, entity_pool_slack);
+    app.grid.reserve(max_chunks, max_chunk_slots, max_entities);
+
+    // level_c gets a copy of the level on every switch, undo and reset
+    app.level_c.chunks.reserve(max_chunks);
+    app.level_c.chunk_origins.reserve(max_chunks);
+    app.level_c.chunk_index.reserve(max_chunk_slots);
 }
 
 #ifdef _DEBUG
@@ -282,7 +442,7 @@ void run_genvec_tests() {
         ++ge->entry.haha;
 
         if (i == 4) {
-            hellos.remove(GenKey{i, ge->gen});
+            hellos.remove(genkey_make(i, ge->gen));
         }
     }
 
@@ -303,113 +463,82 @@ void run_genvec_tests() {
         }
     }
 }
-#endif
-
-void feed_boxes_to_renderer(App &app, Renderer &r) {
 
-    vec<Shape> hierarchy;
-    hierarchy.reserve(4);
+void run_slotmap_tests() {
 
-    // looping entities
-    for (u64 i = 0; i < app.es.things.size(); ++i) {
-        auto &ge = app.es.things[i];
-
-        if (!ge.live) {
-            continue;
-        }
+    struct Hello {
+        i32 haha;
+    };
 
-        if (!ge.entry.visible) {
+    SlotMap<Hello> hellos = {};
+
+    GenKey k1 = hellos.add(Hello{1});
+    GenKey k2 = hellos.add(Hello{2});
+    GenKey k3 = hellos.add(Hello{3});
+    GenKey k4 = hellos.add(Hello{4});
+
+    // removing from the middle moves the last value into the hole
+    hellos.remove(k2);
+    lassert(hellos.values.size() == 3);
+    lassert(hellos.values[1].haha == 4);
+    lassert(hellos.get(k2) == nullptr);
+    lassert(hellos.get(k4)->haha == 4);
+
+    // the freed slot is reused with a new gen
+    GenKey k5 = hellos.add(Hello{5});
+    lassert(k5.index == k2.index);
+    lassert(!genkey_eq(k5, k2));
+    lassert(hellos.get(k2) == nullptr);
+    lassert(hellos.get(k5)->haha == 5);
+
+    // removing while iterating
+    for (u64 i = 0; i < hellos.values.size();) {
+        if (hellos.values[i].haha % 2 == 1) {
+            hellos.remove(hellos.key_of(i));
             continue;
         }
+        ++i;
+    }
 
-        hierarchy.clear();
-        hierarchy.push_back(ge.entry.box);
-
-        // constructing hierarchy
-        {
-            Entity *e_temp = &ge.entry;
-
-            while (e_temp->has_anchor) {
-                Entity *a = app.es.get(e_temp->anchor_id);
-                lassert(a != nullptr);
-                hierarchy.push_back(a->box);
-                e_temp = a;
-            }
-        }
-
-        Shape new_box = {};
-
-        // reverse iteration of the hierarchy (top to bottom)
-        for (i32 i_hier = (i32)hierarchy.size() - 1; i_hier >= 0; --i_hier) {
-            Shape &b = hierarchy[i_hier];
-
-            XMMATRIX anchor_rot_mat;
-
-            // the position calc
-            {
-                XMVECTOR box_point = XMLoadFloat3(&b.pos);
-                XMVECTOR anchor_center = XMLoadFloat3(&new_box.pos);
-
-                XMVECTOR translated_point = box_point;
+    lassert(hellos.values.size() == 1);
+    lassert(hellos.get(k1) == nullptr);
+    lassert(hellos.get(k3) == nullptr);
+    lassert(hellos.get(k5) == nullptr);
+    lassert(hellos.get(k4)->haha == 4);
+    lassert(genkey_eq(hellos.key_of(0), k4));
 
-                if (math::rot_is_valid(new_box.rot)) {
-                    XMVECTOR anchor_rot = XMLoadFloat4(&new_box.rot);
-                    anchor_rot_mat = XMMatrixRotationAxis(anchor_rot, new_box.rot.w);
-                } else {
-                    anchor_rot_mat = XMMatrixIdentity();
-                }
+    hellos.remove_all();
+    lassert(hellos.values.size() == 0);
+    lassert(hellos.get(k4) == nullptr);
+}
+#endif
 
-                XMVECTOR transformed_point = XMVector3Transform(translated_point, anchor_rot_mat);
+void feed_boxes_to_renderer(App &app, Renderer &r) {
 
-                // translate the point back to the original position
-                transformed_point += anchor_center;
+    EntitySystem &es = app.es;
 
-                XMStoreFloat3(&new_box.pos, transformed_point);
-            }
+    // only entities whose shape or anchors changed get their world transform rebuilt
+    es.update_world();
 
-            // color calc (alpha mul)
-            new_box.color = v4(b.color.x, b.color.y, b.color.z, new_box.color.w * b.color.w);
-
-            // scale calc
-            new_box.scale = math::v3_mul(b.scale, new_box.scale);
-
-            // rot calc
-            if (math::rot_is_valid(b.rot)) {
-                XMVECTOR box_rot = XMLoadFloat4(&b.rot);
-                XMMATRIX box_rot_mat = XMMatrixRotationAxis(box_rot, b.rot.w);
-                XMMATRIX new_box_rot = box_rot_mat * anchor_rot_mat;
-
-                // converting rot matrix back to axis+angle
-                XMVECTOR rot_quat;
-                XMVECTOR _unused;
-                XMMatrixDecompose(&_unused, &rot_quat, &_unused, new_box_rot);
-                XMVECTOR rot_axis;
-                f32 rot_angle;
-                XMQuaternionToAxisAngle(&rot_axis, &rot_angle, rot_quat);
-                XMStoreFloat4(&new_box.rot, rot_axis);
-                new_box.rot.w = rot_angle;
-            }
-
-            new_box.kind = b.kind;
+    // looping entities
+    for (u32 e_i = 0; e_i < es.count(); ++e_i) {
+        if (!es.visible[e_i]) {
+            continue;
         }
 
-        rend::draw_shape(r, new_box);
-    }
-}
-
-void delete_entity(void *app_void, TimerProcData data) {
-    App &app = *(App *)app_void;
+        ShapeInstance inst = {};
+        es.blend_world(e_i, app.sim_alpha, inst.world, inst.pos, inst.color);
+        inst.kind = es.kind[e_i];
 
-    lassert(data.what == TimerDataWhat::GenKey);
-    app.es.remove(data.data.entity_key);
+        rend::draw_shape_instance(r, inst);
+    }
 }
 
-void level_finish_anim_level(void *app_void, TimerProcData _data) {
-    App &app = *(App *)app_void;
+void level_finish_anim_level(App &app) {
 
     for (auto anchor : app.anchors) {
-        Entity *e = app.es.get(anchor);
-        if (!e) {
+        u32 e_i = app.es.find(anchor);
+        if (e_i == SLOT_NONE) {
             continue;
         }
         Animated a = {};
@@ -424,13 +553,13 @@ void level_finish_anim_level(void *app_void, TimerProcData _data) {
         a.ent.what = EntityProp::Position;
         a.duration_s = transition_rot_duration;
         a.ease_function = level_rot_ease_function;
-        app.as.push_back(a);
+        anims_add(app.as, app.es, a);
     }
 }
 
-void level_finish_anim_switch(void *app_void, TimerProcData _data) {
-    App &app = *(App *)app_void;
-    app.as.clear();
+void level_finish_anim_switch(App &app) {
+    anims_clear(app.as);
+    app.move_anim_keys.clear();
 
     if (app.current_level + 1 < app.levels.size()) {
         app_switch_to_level(app, app.current_level + 1, true);
@@ -439,56 +568,41 @@ void level_finish_anim_switch(void *app_void, TimerProcData _data) {
     }
 }
 
-void level_finish_anim_entities(void *app_void, TimerProcData _data) {
+void level_finish_anim_entities(App &app) {
+    Coord coord_now = get_player_coord(app.level_c);
 
-    App &app = *(App *)app_void;
+    for (const auto &ge : app.grid.at(coord_now)) {
+        if (ge.tile != Tile::Player) {
+            continue;
+        }
 
-    for (u32 plane_i = 0; const auto &p : app.level_c.data) {
-        if (plane_i >= app.level_c.plane_count)
-            break;
-        for (i32 col_i = 0; const auto &column : p) {
-            for (i32 row_i = 0; const auto &cell : column) {
-                for (const auto &te : cell) {
-                    if (te.tile == Tile::Player) {
-
-                        if (!te.has_entity)
-                            continue;
-                        Entity *e = app.es.get(te.entity_id);
-                        if (!e) {
-                            continue;
-                        }
-
-                        Coord coord_now = Coord{col_i, row_i};
-
-                        Animated a = {};
-                        a.the_thing = AnimatedThing::Entity;
-                        a.ent.entity_id = te.entity_id;
-                        a.ent.prev = math::v3tov4(e->box.pos);
-
-                        v3 target_pos = coord_to_v3(coord_now);
-                        target_pos.y += unit_length * 20.0f;
-
-                        a.ent.target = math::v3tov4(target_pos);
-                        a.ent.what = EntityProp::Position;
-                        a.duration_s = 3.0f;
-                        app.as.push_back(a);
-
-                        a.ent.what = EntityProp::Color;
-                        a.ent.prev = e->box.color;
-
-                        v4 color_target = e->box.color;
-                        color_target.w = 0.f;
-                        a.duration_s = 1.0f;
-                        a.ent.target = color_target;
-
-                        app.as.push_back(a);
-                    }
-                }
-                ++row_i;
-            }
-            ++col_i;
+        u32 e_i = app.es.find(ge.key);
+        if (e_i == SLOT_NONE) {
+            continue;
         }
-        ++plane_i;
+
+        Animated a = {};
+        a.the_thing = AnimatedThing::Entity;
+        a.ent.entity_id = ge.key;
+        a.ent.prev = math::v3tov4(app.es.pos[e_i]);
+
+        v3 target_pos = coord_to_v3(coord_now);
+        target_pos.y += unit_length * 20.0f;
+
+        a.ent.target = math::v3tov4(target_pos);
+        a.ent.what = EntityProp::Position;
+        a.duration_s = 3.0f;
+        anims_add(app.as, app.es, a);
+
+        a.ent.what = EntityProp::Color;
+        a.ent.prev = app.es.color[e_i];
+
+        v4 color_target = app.es.color[e_i];
+        color_target.w = 0.f;
+        a.duration_s = 1.0f;
+        a.ent.target = color_target;
+
+        anims_add(app.as, app.es, a);
     }
 }
 
@@ -568,65 +682,121 @@ void level_finish_anim_ripple(App &app) {
     // getting goal coord
     Coord goal_coord = get_goal_coord(app.level_c);
 
-    for (u32 plane_i = 0; const auto &p : app.level_c.data) {
-        if (plane_i >= app.level_c.plane_count)
-            break;
-        for (i32 col_i = 0; const auto &column : p) {
-            for (i32 row_i = 0; const auto &cell : column) {
-                for (const auto &te : cell) {
-                    if (te.tile != Tile::Player || te.tile == Tile::Goal) {
-                        if (!te.has_entity)
-                            continue;
-                        Entity *e = app.es.get(te.entity_id);
-                        if (!e) {
-                            continue;
-                        }
-
-                        // calculate distance to goal
-                        Coord coord_now = Coord{col_i, row_i};
-                        v2 dist_to_goal_vec = v2(f32(goal_coord.x - coord_now.x), f32(goal_coord.y - coord_now.y));
-                        XMVECTOR v = XMLoadFloat2(&dist_to_goal_vec);
-                        XMVECTOR v_l = XMVector2Length(v);
-                        f32 len;
-                        XMStoreFloat(&len, v_l);
-
-                        v3 future_pos = anims_get_future_pos(app.as, app.es, te.entity_id);
-
-                        array<v3, 3> keyframes = {
-                            v3(future_pos.x, future_pos.y - unit_length * 0.5f, future_pos.z),
-                            v3(future_pos.x, future_pos.y + unit_length * 0.5f, future_pos.z),
-                            v3(future_pos.x, future_pos.y, future_pos.z),
-                        };
-
-                        Animated a = {};
-                        a.ent.entity_id = te.entity_id;
-                        a.ent.prev = math::v3tov4(future_pos);
-                        a.ent.target = math::v3tov4(keyframes[0]);
-                        a.ent.what = EntityProp::Position;
-                        a.delay_s = len * 0.03f;
-                        a.duration_s = 0.1f;
-                        a.conflict_resolution = AnimationConflictResolution::FastForwardOthers;
-                        a.ease_function = EaseFunction::SineInOut;
-                        app.as.push_back(a);
-
-                        v4 temp = a.ent.target;
-                        a.ent.target = math::v3tov4(keyframes[1]);
-                        a.ent.prev = temp;
-                        a.delay_s += a.duration_s;
-                        app.as.push_back(a);
-
-                        temp = a.ent.target;
-                        a.ent.target = math::v3tov4(keyframes[2]);
-                        a.ent.prev = temp;
-                        a.delay_s += a.duration_s;
-                        app.as.push_back(a);
-                    }
-                }
-                ++row_i;
+    for (Coord coord_now : app.grid.occupied) {
+        for (const auto &ge : app.grid.at(coord_now)) {
+            if (ge.tile == Tile::Player) {
+                continue;
+            }
+            u32 e_i = app.es.find(ge.key);
+            if (e_i == SLOT_NONE) {
+                continue;
             }
-            ++col_i;
+
+            // calculate distance to goal
+            v2 dist_to_goal_vec = v2(f32(goal_coord.x - coord_now.x), f32(goal_coord.y - coord_now.y));
+            XMVECTOR v = XMLoadFloat2(&dist_to_goal_vec);
+            XMVECTOR v_l = XMVector2Length(v);
+            f32 len;
+            XMStoreFloat(&len, v_l);
+
+            v3 future_pos = anims_get_future_pos(app.as, app.es, ge.key);
+
+            Animated a = {};
+            a.ent.entity_id = ge.key;
+            a.ent.prev = math::v3tov4(future_pos);
+            a.ent.what = EntityProp::Position;
+            a.delay_s = len * 0.03f;
+            a.conflict_resolution = AnimationConflictResolution::FastForwardOthers;
+
+            // dip, hop, back down
+            v3 dip = v3(future_pos.x, future_pos.y - unit_length * 0.5f, future_pos.z);
+            v3 hop = v3(future_pos.x, future_pos.y + unit_length * 0.5f, future_pos.z);
+            anim_add_key(app.as, a, math::v3tov4(dip), 0.1f, EaseFunction::SineInOut);
+            anim_add_key(app.as, a, math::v3tov4(hop), 0.1f, EaseFunction::SineInOut);
+            anim_add_key(app.as, a, math::v3tov4(future_pos), 0.1f, EaseFunction::SineInOut);
+            anims_add(app.as, app.es, a);
         }
-        ++plane_i;
+    }
+}
+
+// returns how many NormalMove events starting at `start` form a walked path of the same tile entity
+u64 get_walk_run_length(span<GameEvent> eks, u64 start) {
+    const GameEvent &first = eks[start];
+
+    u64 i = start + 1;
+    for (; i < eks.size(); ++i) {
+        const GameEvent &prev = eks[i - 1];
+        const GameEvent &ev = eks[i];
+
+        bool continues_path = ev.kind == EventKind::NormalMove && ev.te.id == first.te.id &&
+                              ev.from.x == prev.to.x && ev.from.y == prev.to.y;
+
+        if (!continues_path)
+            break;
+    }
+
+    return i - start;
+}
+
+// animates a walked path. every straight run of the path is one linear key, and the keys go in keyframe
+//  animations of up to ANIM_MAX_KEYS, so a long walk is a handful of Animated entries chained with delays.
+void animate_walk_path(App &app, span<GameEvent> run) {
+    const GameEvent &first = run[0];
+
+    if (!first.te.has_entity)
+        return;
+
+    u32 e_i = app.es.find(first.te.entity_id);
+    if (e_i == SLOT_NONE) {
+        return;
+    }
+
+    const f32 elevation = get_elevation(app.es.get_shape(e_i));
+
+    Animated a = {};
+    a.ent.entity_id = first.te.entity_id;
+    a.ent.what = EntityProp::Position;
+    a.ent.prev = math::v3tov4(app.es.pos[e_i]);
+
+    // the first animation replaces whatever was moving the entity before,
+    //  the rest must not kill the ones queued before them.
+    a.conflict_resolution = AnimationConflictResolution::KillOthers;
+
+    u64 seg_begin = 0;
+    for (u64 i = 1; i <= run.size(); ++i) {
+        bool is_last = i == run.size();
+
+        if (!is_last) {
+            const GameEvent &seg_ev = run[seg_begin];
+            const GameEvent &ev = run[i];
+
+            i32 seg_dx = seg_ev.to.x - seg_ev.from.x;
+            i32 seg_dy = seg_ev.to.y - seg_ev.from.y;
+
+            bool same_direction = (ev.to.x - ev.from.x) == seg_dx && (ev.to.y - ev.from.y) == seg_dy;
+
+            if (same_direction)
+                continue;
+        }
+
+        v3 pos_to = coord_to_v3(run[i - 1].to);
+        pos_to.y += elevation;
+
+        f32 seg_steps = (f32)(i - seg_begin);
+        anim_add_key(app.as, a, math::v3tov4(pos_to), walk_step_duration * seg_steps, EaseFunction::Linear);
+        seg_begin = i;
+
+        if (a.key_count < ANIM_MAX_KEYS && !is_last) {
+            continue;
+        }
+
+        anims_add(app.as, app.es, a);
+
+        // the next one starts where and when this one ends
+        a.ent.prev = a.ent.target;
+        a.delay_s += a.duration_s;
+        a.key_count = 0;
+        a.conflict_resolution = AnimationConflictResolution::DoNothing;
     }
 }
 
@@ -634,6 +804,17 @@ void app_update_boxes(App &app, span<GameEvent> eks) {
 
     const f32 move_dur = move_anim_duration;
 
+    // catching up: what the last move still has in flight lands right away, so this move starts where the
+    //  last one ended and fast input never queues behind older animations
+    anims_finish(app.as, app.es, app.move_anim_keys);
+    app.move_anim_keys.clear();
+
+    for (const auto &ev : eks) {
+        if (ev.te.has_entity) {
+            app.move_anim_keys.push_back(ev.te.entity_id);
+        }
+    }
+
     bool has_player_fall = false;
 
     for (const auto &ev : eks) {
@@ -643,45 +824,51 @@ void app_update_boxes(App &app, span<GameEvent> eks) {
         }
     }
 
-    for (const auto &ev : eks) {
+    for (u64 ev_i = 0; ev_i < eks.size(); ++ev_i) {
+        const GameEvent &ev = eks[ev_i];
+
         switch (ev.kind) {
         case EventKind::NormalMove: {
+            u64 run_length = get_walk_run_length(eks, ev_i);
+            if (run_length > 1) {
+                animate_walk_path(app, eks.subspan(ev_i, run_length));
+                ev_i += run_length - 1;
+                continue;
+            }
+
             if (!ev.te.has_entity)
                 continue;
 
-            Entity *e = app.es.get(ev.te.entity_id);
-            if (!e) {
+            u32 e_i = app.es.find(ev.te.entity_id);
+            if (e_i == SLOT_NONE) {
                 continue;
             }
 
             v3 pos_to = coord_to_v3(ev.to);
-            pos_to.y += get_elevation(e->box);
+            pos_to.y += get_elevation(app.es.get_shape(e_i));
             Animated a = {};
             a.ent.entity_id = ev.te.entity_id;
-            a.ent.prev = math::v3tov4(e->box.pos);
+            a.ent.prev = math::v3tov4(app.es.pos[e_i]);
             a.ent.target = math::v3tov4(pos_to);
             a.ent.what = EntityProp::Position;
             a.duration_s = move_dur;
-            app.as.push_back(a);
+            anims_add(app.as, app.es, a);
         } break;
         case EventKind::MirrorTeleport: {
             if (!ev.te.has_entity)
                 continue;
 
-            Entity *e = app.es.get(ev.te.entity_id);
-            if (!e) {
+            u32 e_i = app.es.find(ev.te.entity_id);
+            if (e_i == SLOT_NONE) {
                 continue;
             }
 
-            v4 color = e->box.color;
+            v4 color = app.es.color[e_i];
 
             // delete position animation if there is one
-            auto remove_start = std::remove_if(app.as.begin(), app.as.end(), [&](const Animated &anim) {
-                return genkey_eq(anim.ent.entity_id, ev.te.entity_id) && anim.ent.what == EntityProp::Position;
-            });
-            app.as.erase(remove_start, app.as.end());
+            anims_kill(app.as, ev.te.entity_id, EntityProp::Position);
 
-            auto clone_key = app.es.add(*e);
+            auto clone_key = app.es.add(app.es.get_entity(e_i));
             Animated a = {};
             a.ent.entity_id = clone_key;
             a.ent.prev = color;
@@ -689,18 +876,18 @@ void app_update_boxes(App &app, span<GameEvent> eks) {
             a.ent.target = color;
             a.ent.what = EntityProp::Color;
             a.duration_s = 0.3f;
-            app.as.push_back(a);
+            anims_add(app.as, app.es, a);
 
-            TimerProcData tpc = {};
-            tpc.what = TimerDataWhat::GenKey;
-            tpc.data.entity_key = clone_key;
-            timer_add_data(app.ts, move_dur, delete_entity, tpc);
+            timer_add(app.ts, move_dur, [&app, clone_key] { app.es.remove(clone_key); });
+            std::erase_if(app.clone_keys, [&app](GenKey k) { return app.es.find(k) == SLOT_NONE; });
+            app.clone_keys.push_back(clone_key);
 
-            e->box.pos = coord_to_v3(ev.to);
-            e->box.pos.y += get_elevation(e->box);
+            v3 pos_to = coord_to_v3(ev.to);
+            pos_to.y += get_elevation(app.es.get_shape(e_i));
+            app.es.set_pos(e_i, pos_to);
 
             if (!has_player_fall)
-                e->box.color.w = 0.0f;
+                app.es.set_color(e_i, v4(color.x, color.y, color.z, 0.0f));
 
             a.ent.entity_id = ev.te.entity_id;
             color.w = 0.0f;
@@ -709,65 +896,60 @@ void app_update_boxes(App &app, span<GameEvent> eks) {
             a.ent.target = color;
 
             if (!has_player_fall)
-                app.as.push_back(a);
+                anims_add(app.as, app.es, a);
         } break;
         case EventKind::BoxFall: {
             if (!ev.te.has_entity)
                 continue;
 
-            Entity *e = app.es.get(ev.te.entity_id);
-            if (!e) {
+            u32 e_i = app.es.find(ev.te.entity_id);
+            if (e_i == SLOT_NONE) {
                 continue;
             }
 
             v3 pos_to = coord_to_v3(ev.to);
-            pos_to.y += get_elevation(e->box);
+            pos_to.y += get_elevation(app.es.get_shape(e_i));
 
+            // slide into the hole, then fall to snap into the floor
             Animated a = {};
             a.ent.entity_id = ev.te.entity_id;
-            a.ent.prev = math::v3tov4(e->box.pos);
-            a.ent.target = math::v3tov4(pos_to);
+            a.ent.prev = math::v3tov4(app.es.pos[e_i]);
             a.ent.what = EntityProp::Position;
             a.conflict_resolution = AnimationConflictResolution::DoNothing;
-            a.duration_s = move_dur;
-            app.as.push_back(a);
-
-            // fall to snap into floor animation
-            a.ent.prev = math::v3tov4(pos_to);
-            v3 pos_void = coord_to_v3(ev.to);
-            a.ent.target = math::v3tov4(pos_void);
-            a.ent.what = EntityProp::Position;
-            a.delay_s = move_dur;
-            a.duration_s = move_dur;
-            app.as.push_back(a);
+            anim_add_key(app.as, a, math::v3tov4(pos_to), move_dur, EaseFunction::SineInOut);
+            anim_add_key(app.as, a, math::v3tov4(coord_to_v3(ev.to)), move_dur, EaseFunction::SineInOut);
+            anims_add(app.as, app.es, a);
 
             // color anim
-            a.ent.prev = e->box.color;
+            a = {};
+            a.ent.entity_id = ev.te.entity_id;
+            a.conflict_resolution = AnimationConflictResolution::DoNothing;
+            a.ent.prev = app.es.color[e_i];
             a.ent.target = FLOOR_COLOR;
             a.ent.what = EntityProp::Color;
             a.duration_s = move_dur;
             a.delay_s = move_dur;
-            app.as.push_back(a);
+            anims_add(app.as, app.es, a);
 
             // scale anim
-            a.ent.prev = math::v3tov4(e->box.scale);
+            a.ent.prev = math::v3tov4(app.es.scale[e_i]);
             a.ent.target = math::v3tov4(FLOOR_SCALE);
             a.ent.what = EntityProp::Scale;
             a.duration_s = move_dur;
             a.delay_s = move_dur;
-            app.as.push_back(a);
+            anims_add(app.as, app.es, a);
         } break;
         case EventKind::PlayerFall: {
             if (!ev.te.has_entity)
                 continue;
 
-            Entity *e = app.es.get(ev.te.entity_id);
-            if (!e) {
+            u32 e_i = app.es.find(ev.te.entity_id);
+            if (e_i == SLOT_NONE) {
                 continue;
             }
 
             v3 pos_to = coord_to_v3(ev.to);
-            pos_to.y += get_elevation(e->box);
+            pos_to.y += get_elevation(app.es.get_shape(e_i));
 
             Animated a = {};
             a.ent.entity_id = ev.te.entity_id;
@@ -779,23 +961,23 @@ void app_update_boxes(App &app, span<GameEvent> eks) {
             a.duration_s = 5.0f;
             a.delay_s = move_dur;
             a.conflict_resolution = AnimationConflictResolution::DoNothing;
-            app.as.push_back(a);
+            anims_add(app.as, app.es, a);
 
             // color anim
-            a.ent.prev = e->box.color;
-            a.ent.target = e->box.color;
+            a.ent.prev = app.es.color[e_i];
+            a.ent.target = app.es.color[e_i];
             a.ent.target.w = 0.0f;
             a.ent.what = EntityProp::Color;
             a.duration_s = 5.0f;
             a.delay_s = move_dur;
-            app.as.push_back(a);
+            anims_add(app.as, app.es, a);
         } break;
         case EventKind::Won: {
             reset_cam_angle(app);
             level_finish_anim_ripple(app);
-            timer_add(app.ts, 0.2f, level_finish_anim_entities);
-            timer_add(app.ts, 0.2f + 0.5f, level_finish_anim_level);
-            timer_add(app.ts, 0.2f + 0.5f + transition_rot_duration, level_finish_anim_switch);
+            timer_add(app.ts, 0.2f, [&app] { level_finish_anim_entities(app); });
+            timer_add(app.ts, 0.2f + 0.5f, [&app] { level_finish_anim_level(app); });
+            timer_add(app.ts, 0.2f + 0.5f + transition_rot_duration, [&app] { level_finish_anim_switch(app); });
         } break;
         default:
             break;
@@ -849,6 +1031,10 @@ void map_input_actions(Input &in) {
     in.action_new(Action::CameraRight);
     in.action_add_key(Action::CameraRight, Key::B);
     in.action_add_joy_button(Action::CameraRight, JoyButton::RS);
+
+    in.action_new(Action::WalkTo);
+    in.action_add_key(Action::WalkTo, Key::T);
+    in.action_add_joy_button(Action::WalkTo, JoyButton::BACK);
 }
 
 void gamestate_menu_tick(App &app, Ctx &ctx, f32 dt_sec) {
@@ -958,12 +1144,12 @@ void do_preview(App &app) {
     if (!ev.te.has_entity)
         return;
 
-    Entity *e = app.es.get(ev.te.entity_id);
-    if (!e) {
+    u32 e_i = app.es.find(ev.te.entity_id);
+    if (e_i == SLOT_NONE) {
         return;
     }
 
-    Entity ghost_e = *e;
+    Entity ghost_e = app.es.get_entity(e_i);
     ghost_e.box.pos = coord_to_v3(ev.to);
     ghost_e.box.pos.y += get_elevation(ghost_e.box);
     ghost_e.box.color = v4(1.f, 0.f, 0.f, 0.3f);
@@ -971,6 +1157,37 @@ void do_preview(App &app) {
     app.preview_keys.push_back(clone_key);
 }
 
+void walk_cursor_place(App &app) {
+    u32 e_i = app.es.find(app.walk_cursor_key);
+    if (e_i == SLOT_NONE) {
+        return;
+    }
+
+    v3 pos = coord_to_v3(app.walk_cursor);
+    pos.y += get_elevation(app.es.get_shape(e_i));
+    app.es.set_pos(e_i, pos);
+}
+
+void walk_select_start(App &app) {
+    Entity cursor_e = {};
+    cursor_e.box.kind = ShapeKind::Sphere;
+    cursor_e.box.scale = v3(0.4f, 0.4f, 0.4f);
+    cursor_e.box.color = v4(0.3f, 1.f, 0.4f, 0.6f);
+    cursor_e.has_anchor = true;
+    cursor_e.anchor_id = app.anchors[0];
+
+    // start the cursor on the player
+    app.walk_cursor = get_player_coord(app.level_c);
+    app.walk_cursor_key = app.es.add(cursor_e);
+    app.walk_selecting = true;
+    walk_cursor_place(app);
+}
+
+void walk_select_end(App &app) {
+    app.es.remove(app.walk_cursor_key);
+    app.walk_selecting = false;
+}
+
 Direction rotate_dir(Direction dir, bool right) {
     if (right) {
         switch (dir) {
@@ -1087,11 +1304,11 @@ void gamestate_game_tick(App &app, Ctx &ctx, f32 dt_sec) {
         const auto add_rot_anim = [&]() {
             Animated a = {};
             a.the_thing = AnimatedThing::Float;
-            a.simple.the_float = &app.cam_controls.cam_y_angle;
+            a.simple.channel = app.cam_angle_anim;
             a.simple.prev = app.cam_controls.cam_y_angle;
             a.simple.target = app.current_angle;
             a.duration_s = cam_rot_duration;
-            app.as.push_back(a);
+            anims_add(app.as, app.es, a);
         };
 
         if (in.was_up(Action::CameraLeft)) {
@@ -1102,15 +1319,47 @@ void gamestate_game_tick(App &app, Ctx &ctx, f32 dt_sec) {
             add_rot_anim();
         }
 
-        if (moved) {
+        if (in.was_up(Action::WalkTo)) {
+            if (app.walk_selecting) {
+                walk_select_end(app);
+            } else {
+                walk_select_start(app);
+            }
+        }
+
+        if (app.walk_selecting && moved) {
+            // moving the cursor instead of the player
+            moved = false;
+
+            if (dir == Direction::JumpAction) {
+                vec<Direction> path = {};
+                if (game_find_path(app.level_c, app.walk_cursor, path)) {
+                    walk_select_end(app);
+                    game_tick_path(path, app.level_c, app.levels[app.current_level].level, app.level_moves, eks);
+                    moved = true;
+                }
+            } else {
+                Coord c = coord_step(app.walk_cursor, dir);
+
+                if (c.x >= 0 && c.y >= 0 && c.x < (i32)app.level_c.width && c.y < (i32)app.level_c.height) {
+                    app.walk_cursor = c;
+                    walk_cursor_place(app);
+                }
+            }
+        } else if (moved) {
             game_tick(dir, app.level_c, app.levels[app.current_level].level, app.level_moves, eks);
-            do_level_sanity_checks(app.level_c);
+        }
+
+        if (moved) {
+            do_level_sanity_checks(app.level_c, eks);
             if (eks.size() > 0) { // things happened
                 // clear previews
                 for (const auto &k : app.preview_keys) {
                     app.es.remove(k);
                 }
+                app.preview_keys.clear();
 
+                app.grid.apply_events(app.level_c, eks);
                 app_update_boxes(app, eks);
                 // log_events(eks);
                 if (is_game_over(eks)) {
@@ -1133,8 +1382,8 @@ void gamestate_game_tick(App &app, Ctx &ctx, f32 dt_sec) {
     }
 
     if (in.was_up(Action::Undo) && !app.completed_game) {
-        game_do_undo(app.level_c, app.levels[app.current_level].level, app.level_moves);
-        set_entities(app, app.level_c, false);
+        game_do_undo(app.level_c, app.levels[app.current_level].level, app.level_moves, app.undo_events);
+        reconcile_entities(app, app.undo_events, app.level_c);
         do_preview(app);
     }
 
@@ -1186,6 +1435,7 @@ void gamestate_info_menu_tick(App &app, Ctx &ctx, f32 dt_sec) {
                        "        R (Y) - Reset level"sv,
                        "        Z or U (X) - Undo last move"sv,
                        "        V and B (LB and RB) - Change camera angle"sv,
+                       "        T (BACK) - Pick a cell to walk to, then SPACE or ENTER (A) to go"sv,
                        "        ESC (B) - Go back"sv,
                        " "sv,
                        "Press >SPACE< to go back."sv};
@@ -1276,6 +1526,7 @@ void app_init(App &app, Ctx &ctx) {
 
 #ifdef _DEBUG
     run_genvec_tests();
+    run_slotmap_tests();
 #endif
 
     Renderer &renderer = *ctx.renderer;
@@ -1291,6 +1542,7 @@ void app_init(App &app, Ctx &ctx) {
     app.cam_controls.init();
     app.cam_controls.cam_y_angle = app.current_angle;
     app.cam_controls.cam_x_angle = 0.84f;
+    app.cam_angle_anim = anims_float_add(app.as, &app.cam_controls.cam_y_angle);
 
     app_on_resize(app, renderer);
 
@@ -1315,10 +1567,12 @@ void app_init(App &app, Ctx &ctx) {
         rend::set_light(r, app.light);
     }
 
-    bool res = load_levels_from_file("assets/levels/1.lvl", app.levels);
+    bool res = load_levels_from_file(app.levels_file, app.levels);
 
     lassert(res);
 
+    app_reserve_pools(app);
+
     app.current_level = 0;
 
     map_input_actions(*ctx.input);
@@ -1367,12 +1621,23 @@ void app_tick(App &app, Ctx &ctx, f32 dt_sec) {
     rend::set_camera(r, app.camera);
     rend::set_text_camera(r, app.text_camera);
 
-    anims_tick(app.as, app.es, dt_sec);
-    timers_tick(app.ts, dt_sec, (void *)&app);
+    app.sim_accumulator_s += math::Min(dt_sec, sim_max_frame_s);
+    while (app.sim_accumulator_s >= sim_step_s) {
+        app_sim_step(app);
+        app.sim_accumulator_s -= sim_step_s;
+    }
+    app.sim_alpha = app.sim_accumulator_s / sim_step_s;
 
     app.time += dt_sec;
 }
 
+void app_sim_step(App &app) {
+    app.es.step_begin();
+    anims_tick(app.as, app.es, sim_step_s);
+    timers_tick(app.ts, sim_step_s);
+    app.es.step_end();
+}
+
 void app_on_resize(App &app, Renderer &renderer) {
     if (app.is_cam_ortho) {
         const f32 ratio = (f32)renderer.client_width / (f32)renderer.client_height;
@@ -1395,8 +1660,22 @@ void app_switch_to_level(App &app, i32 level_number, bool do_transition_anim) {
     app.level_moves.clear();
 
     app.completed_game = false;
+
+#ifdef _DEBUG
+    u64 level_chunks_capacity = app.level_c.chunks.capacity();
+    u64 level_origins_capacity = app.level_c.chunk_origins.capacity();
+    u64 level_index_capacity = app.level_c.chunk_index.capacity();
+#endif
+
     app.level_c = level;
 
+#ifdef _DEBUG
+    // app_reserve_pools sizes level_c for the biggest level, so the copy reuses its memory
+    lassert(app.level_c.chunks.capacity() == level_chunks_capacity);
+    lassert(app.level_c.chunk_origins.capacity() == level_origins_capacity);
+    lassert(app.level_c.chunk_index.capacity() == level_index_capacity);
+#endif
+
     // positioning camera
     {
         // setting camera position, centering it on level
@@ -5,6 +5,7 @@
 #include "camera.hpp"
 #include "gen_vec.hpp"
 #include "gameplay.hpp"
+#include "entity_grid.hpp"
 #include "timer.hpp"
 #include "animation.hpp"
 
@@ -33,6 +34,8 @@ struct DrunkParams {
 };
 
 const inline constexpr f32 initial_cam_angle = math::Tau * 0.0f;
+// animations and timers run in steps this long, so they play out the same at any frame rate
+const inline constexpr f32 sim_step_s = 1.0f / 240.0f;
 
 struct App {
     Camera camera;
@@ -46,6 +49,8 @@ struct App {
     Camera text_camera;
     v3 text_cam_pos;
     CameraControlsOrbital cam_controls;
+    // float channel in `as` animating cam_controls.cam_y_angle
+    GenKey cam_angle_anim;
     FrameTimeStats fps_stats;
     bool draw_grid;
     DirectionalLight light;
@@ -63,17 +68,30 @@ struct App {
 
     // all levels are stored here
     vec<LevelNamed> levels;
+    // where levels are loaded from, --levels <file> on the command line
+    string levels_file = "assets/levels/1.lvl";
 
     // current Level state
     i32 current_level;
     Level level_c; // current state of level
     bool player_has_control = true;
     vec<Direction> level_moves;
+    vec<GameEvent> undo_events; // events of the move the last undo took back
+    vec<Coord> undo_cells;
     bool completed_game;
 
     vec<GenKey> anchors; // anchors for the planes
+    EntityGrid grid; // entities of level_c by cell
 
     vec<GenKey> preview_keys;
+    vec<GenKey> clone_keys; // mirror clones fading out, some may already be gone
+    // entities the last move animated, their animations are played to the end when the next move comes in
+    vec<GenKey> move_anim_keys;
+
+    // walk to cell state
+    bool walk_selecting;
+    Coord walk_cursor;
+    GenKey walk_cursor_key;
 
     GameState game_state = GameState::Menu;
 
@@ -81,9 +99,16 @@ struct App {
     MenuState menu_state;
     DrunkParams drunk_params;
     f32 time;
+
+    // frame time not simulated yet, less than sim_step_s between frames
+    f32 sim_accumulator_s;
+    // how far the frame is into the next step, entity transforms are blended by it
+    f32 sim_alpha;
 };
 
 void app_init(App &app, Ctx &ctx);
 void app_tick(App &app, Ctx &ctx, f32 dt_sec);
+// one fixed step of everything the simulation drives: animations, then timers
+void app_sim_step(App &app);
 void app_on_resize(App &app, Renderer &renderer);
 void app_switch_to_level(App &app, i32 level_number, bool do_transition_anim);
\ No newline at end of file
@@ -20,15 +20,10 @@ void imgui_box_controls(Shape &b, u64 box_n) {
 }
 
 void imgui_controls_for_all_boxes(App &app) {
-    for (u64 i = 0; i < app.es.things.size(); ++i) {
-        auto &ge = app.es.things[i];
-
-        if (!ge.live) {
-            continue;
-        }
-
-        Shape &b = ge.entry.box;
+    for (u32 i = 0; i < app.es.count(); ++i) {
+        Shape b = app.es.get_shape(i);
         imgui_box_controls(b, i);
+        app.es.set_shape(i, b);
     }
 }
 
@@ -57,7 +52,7 @@ void show_imgui(App &app, Renderer &renderer, f32 dt_sec) {
             log("do it");
             run_command_checked("python ldtk_to_game.py --debug", ".\\docs");
             app.levels.clear();
-            bool res = load_levels_from_file("assets/levels/1.lvl", app.levels);
+            bool res = load_levels_from_file(app.levels_file, app.levels);
             lassert(res);
 
             if (app.current_level >= app.levels.size()) {
@@ -132,6 +127,18 @@ void show_imgui(App &app, Renderer &renderer, f32 dt_sec) {
         }
     }
 
+    // animation and timer counters
+    {
+        const AnimStats &st = app.as.stats;
+        ImGui::Text("anims - active: %u, delayed: %u, written last tick: %u", (u32)app.as.anims.size(),
+                    (u32)app.as.pending.size(), st.written_last_tick);
+        ImGui::Text("anims - added: %llu, started: %llu", st.added, st.started);
+        ImGui::Text("anims - conflicts resolved: %llu, finished early: %llu, erased: %llu", st.conflicts_resolved,
+                    st.finished_early, st.removed);
+        ImGui::Text("timers - pending: %u, fired: %llu, cancelled: %llu", (u32)app.ts.timers.values.size(),
+                    app.ts.fired, app.ts.cancelled);
+    }
+
     fps_stats_tick_and_draw(&app.fps_stats, dt_sec);
 
     // hierarchy test
@@ -0,0 +1,348 @@
+#include "entity.hpp"
+
+#include <algorithm>
+#include <string.h>
+
+namespace {
+
+// calls f on every per-entity array, the ones that move together when an entity is swapped into a hole
+template <typename F>
+void for_each_column(EntitySystem &es, F f) {
+    f(es.pos);
+    f(es.scale);
+    f(es.rot);
+    f(es.color);
+    f(es.kind);
+    f(es.visible);
+    f(es.has_anchor);
+    f(es.anchor_id);
+    f(es.world);
+    f(es.world_pos);
+    f(es.world_scale);
+    f(es.world_rot);
+    f(es.world_color);
+    f(es.dirty);
+    f(es.prev_world_pos);
+    f(es.prev_world_scale);
+    f(es.prev_world_rot);
+    f(es.prev_world_color);
+    f(es.has_prev_world);
+}
+
+u32 anchor_index(const EntitySystem &es, u32 i) {
+    return es.has_anchor[i] ? es.find(es.anchor_id[i]) : SLOT_NONE;
+}
+
+// parent indices, depths and the entities anchored to each one
+void rebuild_hierarchy(EntitySystem &es) {
+    u32 count = es.count();
+
+    es.parent.resize(count);
+    es.depth.resize(count);
+
+    for (u32 i = 0; i < count; ++i) {
+        es.parent[i] = anchor_index(es, i);
+        lassert(!es.has_anchor[i] || es.parent[i] != SLOT_NONE);
+
+        u32 d = 0;
+        for (u32 a_i = es.parent[i]; a_i != SLOT_NONE; a_i = anchor_index(es, a_i)) {
+            ++d;
+            lassert(d <= count); // anchors can't loop
+        }
+
+        es.depth[i] = d;
+    }
+
+    // counting sort by parent, the children of p end up in children[child_starts[p], child_starts[p + 1])
+    vec<u32> &starts = es.child_starts;
+    starts.assign(count + 1, 0);
+    for (u32 p : es.parent) {
+        if (p != SLOT_NONE) {
+            ++starts[p + 1];
+        }
+    }
+    for (u32 p = 1; p < starts.size(); ++p) {
+        starts[p] += starts[p - 1];
+    }
+
+    es.children.resize(starts[count]);
+    vec<u32> &next = es.compose_list; // scratch, compose_dirty fills it after this
+    next.assign(starts.begin(), starts.end() - 1);
+    for (u32 i = 0; i < count; ++i) {
+        if (es.parent[i] != SLOT_NONE) {
+            es.children[next[es.parent[i]]++] = i;
+        }
+    }
+
+    es.hierarchy_dirty = false;
+}
+
+// the world transform of i, from its local shape and its parent's world transform.
+// matches how shapes were composed before: the parent rotation moves the position but not the scale,
+//  scales multiply per axis and the parent only contributes its alpha to the color.
+void compose_world(EntitySystem &es, u32 i, u32 p) {
+    XMVECTOR parent_pos = XMVectorZero();
+    XMVECTOR parent_rot = XMQuaternionIdentity();
+    XMVECTOR parent_scale = XMVectorSet(1.0f, 1.0f, 1.0f, 0.0f);
+    f32 parent_alpha = 1.0f;
+
+    if (p != SLOT_NONE) {
+        parent_pos = XMLoadFloat3(&es.world_pos[p]);
+        parent_rot = XMLoadFloat4(&es.world_rot[p]);
+        parent_scale = XMLoadFloat3(&es.world_scale[p]);
+        parent_alpha = es.world_color[p].w;
+    }
+
+    // normalized because the debug ui edits the components by hand
+    XMVECTOR local_rot = math::quat_load(es.rot[i]);
+
+    XMVECTOR w_pos = XMVector3Rotate(XMLoadFloat3(&es.pos[i]), parent_rot) + parent_pos;
+    XMVECTOR w_rot = XMQuaternionMultiply(local_rot, parent_rot);
+    XMVECTOR w_scale = XMLoadFloat3(&es.scale[i]) * parent_scale;
+
+    XMStoreFloat3(&es.world_pos[i], w_pos);
+    XMStoreFloat4(&es.world_rot[i], w_rot);
+    XMStoreFloat3(&es.world_scale[i], w_scale);
+
+    v4 c = es.color[i];
+    es.world_color[i] = v4(c.x, c.y, c.z, c.w * parent_alpha);
+
+    XMMATRIX world = XMMatrixScalingFromVector(w_scale) * XMMatrixRotationQuaternion(w_rot) *
+                     XMMatrixTranslationFromVector(w_pos);
+    XMStoreFloat4x4(&es.world[i], world);
+}
+
+void mark_dirty(EntitySystem &es, u32 i) {
+    if (!es.dirty[i]) {
+        es.dirty[i] = 1;
+        es.dirty_keys.push_back(es.table.key_of(i));
+    }
+}
+
+// composes every entity whose shape or anchors changed. with snap, the previous step's transform jumps to the
+//  new one too, so the change isn't blended. only the dirty entities and the ones anchored to them are looked at.
+void compose_dirty(EntitySystem &es, bool snap) {
+    if (es.hierarchy_dirty) {
+        rebuild_hierarchy(es);
+    }
+
+    vec<u32> &list = es.compose_list;
+    list.clear();
+
+    // removed entities leave stale keys behind
+    for (GenKey k : es.dirty_keys) {
+        u32 i = es.find(k);
+        if (i != SLOT_NONE) {
+            list.push_back(i);
+        }
+    }
+    es.dirty_keys.clear();
+
+    // entities anchored to a dirty one move with it. the list grows while it's walked, so this reaches all of them
+    for (u64 n = 0; n < list.size(); ++n) {
+        u32 i = list[n];
+        for (u32 c = es.child_starts[i]; c < es.child_starts[i + 1]; ++c) {
+            u32 child = es.children[c];
+            if (!es.dirty[child]) {
+                es.dirty[child] = 1;
+                list.push_back(child);
+            }
+        }
+    }
+
+    // parents before children
+    std::sort(list.begin(), list.end(), [&es](u32 a, u32 b) { return es.depth[a] < es.depth[b]; });
+
+    for (u32 i : list) {
+        es.dirty[i] = 0;
+        compose_world(es, i, es.parent[i]);
+
+        if (snap || !es.has_prev_world[i]) {
+            es.prev_world_pos[i] = es.world_pos[i];
+            es.prev_world_scale[i] = es.world_scale[i];
+            es.prev_world_rot[i] = es.world_rot[i];
+            es.prev_world_color[i] = es.world_color[i];
+            es.has_prev_world[i] = 1;
+        }
+
+        if (!snap) {
+            es.stepped_keys.push_back(es.table.key_of(i));
+        }
+    }
+}
+
+} // namespace
+
+// --------------------------------- EXPORTED FUNCTIONS (START) ---------------------------------
+
+GenKey EntitySystem::add(const Entity &e) {
+    GenKey key = table.add();
+
+    pos.push_back(e.box.pos);
+    scale.push_back(e.box.scale);
+    rot.push_back(e.box.rot);
+    color.push_back(e.box.color);
+    kind.push_back(e.box.kind);
+    visible.push_back(e.visible);
+    has_anchor.push_back(e.has_anchor);
+    anchor_id.push_back(e.anchor_id);
+
+    // filled by the next update_world
+    world.push_back(m4{});
+    world_pos.push_back(v3{});
+    world_scale.push_back(v3{});
+    world_rot.push_back(v4{});
+    world_color.push_back(v4{});
+    dirty.push_back(1);
+    dirty_keys.push_back(key);
+    prev_world_pos.push_back(v3{});
+    prev_world_scale.push_back(v3{});
+    prev_world_rot.push_back(v4{});
+    prev_world_color.push_back(v4{});
+    has_prev_world.push_back(0);
+
+    hierarchy_dirty = true;
+
+    return key;
+}
+
+void EntitySystem::remove(GenKey k) {
+    u32 hole, last;
+    if (!table.remove(k, hole, last))
+        return;
+
+    // moving the last entity into the hole, array by array. its cached world transform moves with it.
+    for_each_column(*this, [hole, last](auto &column) {
+        if (hole != last) {
+            column[hole] = column[last];
+        }
+        column.pop_back();
+    });
+
+    hierarchy_dirty = true;
+}
+
+// safe way to "clear"
+void EntitySystem::remove_all() {
+    table.remove_all();
+    for_each_column(*this, [](auto &column) { column.clear(); });
+    dirty_keys.clear();
+    stepped_keys.clear();
+    hierarchy_dirty = true;
+}
+
+void EntitySystem::clear() {
+    remove_all();
+    table.clear();
+}
+
+void EntitySystem::reserve(u32 n) {
+    table.reserve(n);
+    for_each_column(*this, [n](auto &column) { column.reserve(n); });
+    dirty_keys.reserve(n);
+    stepped_keys.reserve(n);
+    parent.reserve(n);
+    depth.reserve(n);
+    child_starts.reserve(n + 1);
+    children.reserve(n);
+    compose_list.reserve(n + 1);
+}
+
+Shape EntitySystem::get_shape(u32 i) const {
+    Shape shape = {};
+    shape.pos = pos[i];
+    shape.scale = scale[i];
+    shape.rot = rot[i];
+    shape.color = color[i];
+    shape.kind = kind[i];
+    return shape;
+}
+
+void EntitySystem::set_shape(u32 i, const Shape &shape) {
+    pos[i] = shape.pos;
+    scale[i] = shape.scale;
+    rot[i] = shape.rot;
+    color[i] = shape.color;
+    kind[i] = shape.kind;
+    mark_dirty(*this, i);
+}
+
+void EntitySystem::set_pos(u32 i, v3 v) {
+    pos[i] = v;
+    mark_dirty(*this, i);
+}
+
+void EntitySystem::set_scale(u32 i, v3 v) {
+    scale[i] = v;
+    mark_dirty(*this, i);
+}
+
+void EntitySystem::set_rot(u32 i, v4 v) {
+    rot[i] = v;
+    mark_dirty(*this, i);
+}
+
+void EntitySystem::set_color(u32 i, v4 v) {
+    color[i] = v;
+    mark_dirty(*this, i);
+}
+
+Entity EntitySystem::get_entity(u32 i) const {
+    Entity e = {};
+    e.box = get_shape(i);
+    e.visible = visible[i] != 0;
+    e.has_anchor = has_anchor[i] != 0;
+    e.anchor_id = anchor_id[i];
+    return e;
+}
+
+void EntitySystem::update_world() {
+    compose_dirty(*this, true);
+}
+
+void EntitySystem::step_begin() {
+    compose_dirty(*this, true);
+
+    // only what the last step composed can have a prev_world behind its world
+    for (GenKey k : stepped_keys) {
+        u32 i = find(k);
+        if (i != SLOT_NONE) {
+            prev_world_pos[i] = world_pos[i];
+            prev_world_scale[i] = world_scale[i];
+            prev_world_rot[i] = world_rot[i];
+            prev_world_color[i] = world_color[i];
+        }
+    }
+    stepped_keys.clear();
+}
+
+void EntitySystem::step_end() {
+    compose_dirty(*this, false);
+}
+
+void EntitySystem::blend_world(u32 i, f32 t, m4 &out_world, v3 &out_pos, v4 &out_color) const {
+    // most entities sit still, their cached transform is already right
+    bool still = memcmp(&prev_world_pos[i], &world_pos[i], sizeof(v3)) == 0 &&
+                 memcmp(&prev_world_scale[i], &world_scale[i], sizeof(v3)) == 0 &&
+                 memcmp(&prev_world_rot[i], &world_rot[i], sizeof(v4)) == 0 &&
+                 memcmp(&prev_world_color[i], &world_color[i], sizeof(v4)) == 0;
+
+    if (still) {
+        out_world = world[i];
+        out_pos = world_pos[i];
+        out_color = world_color[i];
+        return;
+    }
+
+    XMVECTOR b_pos = XMVectorLerp(XMLoadFloat3(&prev_world_pos[i]), XMLoadFloat3(&world_pos[i]), t);
+    XMVECTOR b_scale = XMVectorLerp(XMLoadFloat3(&prev_world_scale[i]), XMLoadFloat3(&world_scale[i]), t);
+    XMVECTOR b_rot = XMQuaternionSlerp(XMLoadFloat4(&prev_world_rot[i]), XMLoadFloat4(&world_rot[i]), t);
+    XMVECTOR b_color = XMVectorLerp(XMLoadFloat4(&prev_world_color[i]), XMLoadFloat4(&world_color[i]), t);
+
+    XMStoreFloat3(&out_pos, b_pos);
+    XMStoreFloat4(&out_color, b_color);
+
+    XMMATRIX b_world = XMMatrixScalingFromVector(b_scale) * XMMatrixRotationQuaternion(b_rot) *
+                       XMMatrixTranslationFromVector(b_pos);
+    XMStoreFloat4x4(&out_world, b_world);
+}
@@ -3,6 +3,8 @@
 #include "renderer.hpp"
 #include "gen_vec.hpp"
 
+// what an entity is made of. only used to build one (EntitySystem::add) or to copy one out (get_entity),
+//  the entity system itself keeps every field in its own array.
 struct Entity {
     Shape box;
     bool visible = true;
@@ -10,4 +12,79 @@ struct Entity {
     GenKey anchor_id;
 };
 
-using EntitySystem = GenVec<Entity>;
\ No newline at end of file
+// Entities as a structure of arrays. index i of every array is the same entity, and the arrays stay packed,
+//  so a pass that only needs positions only streams positions. Keys go through `table` like in SlotMap,
+//  and remove swaps the last entity into the hole.
+// The local shape arrays can be read directly, but writes go through the setters so the cached world
+//  transform knows it has to be rebuilt.
+struct EntitySystem {
+    vec<v3> pos;
+    vec<v3> scale;
+    vec<v4> rot; // quaternion
+    vec<v4> color;
+    vec<ShapeKind> kind;
+    vec<u8> visible;
+    vec<u8> has_anchor;
+    vec<GenKey> anchor_id;
+
+    // world transforms, up to date after update_world. the shape of an entity composed with all its anchors.
+    vec<m4> world;
+    vec<v3> world_pos;
+    vec<v3> world_scale;
+    vec<v4> world_rot; // quaternion
+    vec<v4> world_color;
+    vec<u8> dirty; // local shape changed since the last update_world, or an anchor's did
+    vec<GenKey> dirty_keys; // the entities set dirty by the setters, so composing doesn't scan the others
+
+    // world transforms as of the start of the current simulation step, see step_begin
+    vec<v3> prev_world_pos;
+    vec<v3> prev_world_scale;
+    vec<v4> prev_world_rot; // quaternion
+    vec<v4> prev_world_color;
+    vec<u8> has_prev_world; // false until the entity's world transform was first computed
+    vec<GenKey> stepped_keys; // composed during the last step, the only ones whose prev_world isn't world
+
+    // who is anchored to whom. rebuilt by the next compose after entities were added or removed.
+    vec<u32> parent; // packed index of the anchor or SLOT_NONE
+    vec<u32> depth; // how many anchors up to the root
+    vec<u32> child_starts; // the entities anchored to i are children[child_starts[i], child_starts[i + 1])
+    vec<u32> children;
+    bool hierarchy_dirty;
+    // scratch for composing, kept around so it doesn't allocate every time
+    vec<u32> compose_list;
+
+    SlotTable table;
+
+    u32 count() const {
+        return table.count();
+    }
+
+    // packed index of the entity, SLOT_NONE if the key is stale
+    u32 find(GenKey k) const {
+        return table.find(k);
+    }
+
+    GenKey add(const Entity &e);
+    void remove(GenKey k);
+    // every key goes stale but all the memory stays, so refilling it up to the reserved count doesn't allocate
+    void remove_all();
+    void clear();
+    void reserve(u32 n);
+
+    Shape get_shape(u32 i) const;
+    void set_shape(u32 i, const Shape &shape);
+    void set_pos(u32 i, v3 v);
+    void set_scale(u32 i, v3 v);
+    void set_rot(u32 i, v4 v);
+    void set_color(u32 i, v4 v);
+    Entity get_entity(u32 i) const;
+
+    // recomputes the world transform of every entity whose shape or anchors changed. changes made outside of a
+    //  simulation step aren't blended, they show up right away.
+    void update_world();
+    // a fixed simulation step runs between these two, what it changes gets blended by blend_world
+    void step_begin();
+    void step_end();
+    // the world transform of i between the start (t = 0) and the end (t = 1) of the last simulation step
+    void blend_world(u32 i, f32 t, m4 &out_world, v3 &out_pos, v4 &out_color) const;
+};
@@ -0,0 +1,134 @@
+#include "entity_grid.hpp"
+
+#include "utils.hpp"
+
+namespace {
+
+bool grid_has_coord(const EntityGrid &grid, Coord c) {
+    return c.x >= 0 && c.y >= 0 && (u32)c.x < grid.width && (u32)c.y < grid.height;
+}
+
+u32 grid_chunks_high(const EntityGrid &grid) {
+    return (grid.height + LEVEL_CHUNK_SIZE - 1) / LEVEL_CHUNK_SIZE;
+}
+
+u32 grid_chunk_slot(const EntityGrid &grid, Coord c) {
+    return ((u32)c.x / LEVEL_CHUNK_SIZE) * grid_chunks_high(grid) + (u32)c.y / LEVEL_CHUNK_SIZE;
+}
+
+u32 grid_cell_in_chunk(Coord c) {
+    return ((u32)c.x % LEVEL_CHUNK_SIZE) * LEVEL_CHUNK_SIZE + (u32)c.y % LEVEL_CHUNK_SIZE;
+}
+
+} // namespace
+
+// --------------------------------- EXPORTED FUNCTIONS (START) ---------------------------------
+
+void EntityGrid::reserve(u32 chunk_count, u32 chunk_slot_count, u32 occupied_count) {
+    chunks.reserve(chunk_count);
+    chunk_index.reserve(chunk_slot_count);
+    occupied.reserve(occupied_count);
+}
+
+void EntityGrid::build(const Level &level) {
+    width = level.width;
+    height = level.height;
+
+    u32 chunks_wide = (width + LEVEL_CHUNK_SIZE - 1) / LEVEL_CHUNK_SIZE;
+
+    chunks.clear();
+    chunk_index.assign(chunks_wide * grid_chunks_high(*this), SLOT_NONE);
+    occupied.clear();
+
+    level_for_each_cell(level, [this](Coord c, const LevelCell &cell) { sync_cell(c, cell); });
+}
+
+void EntityGrid::apply_events(const Level &level, span<GameEvent> events) {
+    lassert(level.width == width && level.height == height);
+
+    for (const auto &ev : events) {
+        switch (ev.kind) {
+        case EventKind::NormalMove:
+        case EventKind::BoxFall:
+        case EventKind::MirrorTeleport:
+            sync_cell(ev.from, level_cell(level, ev.from));
+            sync_cell(ev.to, level_cell(level, ev.to));
+            break;
+        // same move as the event before them, or no move at all
+        case EventKind::PlayerFall:
+        case EventKind::Won:
+            break;
+        }
+    }
+}
+
+span<const GridEntity> EntityGrid::at(Coord c) const {
+    if (!grid_has_coord(*this, c)) {
+        return {};
+    }
+
+    u32 chunk_i = chunk_index[grid_chunk_slot(*this, c)];
+    if (chunk_i == SLOT_NONE) {
+        return {};
+    }
+
+    u32 cell_i = grid_cell_in_chunk(c);
+    return span<const GridEntity>(chunks[chunk_i].cells[cell_i].data(), chunks[chunk_i].counts[cell_i]);
+}
+
+void EntityGrid::clear() {
+    width = 0;
+    height = 0;
+    chunks.clear();
+    chunk_index.clear();
+    occupied.clear();
+}
+
+void EntityGrid::sync_cell(Coord c, const LevelCell &cell) {
+    if (!grid_has_coord(*this, c)) {
+        return;
+    }
+
+    u8 count = 0;
+    array<GridEntity, CELL_SLOT_COUNT> entities;
+
+    for (const auto &te : cell) {
+        if (te.tile == Tile::Empty || !te.has_entity) {
+            continue;
+        }
+        entities[count++] = GridEntity{te.entity_id, te.tile};
+    }
+
+    u32 &chunk_i = chunk_index[grid_chunk_slot(*this, c)];
+
+    // nothing to store and nothing stored
+    if (chunk_i == SLOT_NONE && count == 0) {
+        return;
+    }
+
+    if (chunk_i == SLOT_NONE) {
+        chunk_i = (u32)chunks.size();
+        chunks.emplace_back();
+        chunks.back().occupied_index.fill(SLOT_NONE);
+    }
+
+    GridChunk &chunk = chunks[chunk_i];
+    u32 cell_i = grid_cell_in_chunk(c);
+
+    chunk.cells[cell_i] = entities;
+    chunk.counts[cell_i] = count;
+
+    u32 &occ_i = chunk.occupied_index[cell_i];
+
+    if (count > 0 && occ_i == SLOT_NONE) {
+        occ_i = (u32)occupied.size();
+        occupied.push_back(c);
+    } else if (count == 0 && occ_i != SLOT_NONE) {
+        // swap remove
+        Coord last = occupied.back();
+        occupied[occ_i] = last;
+        chunks[chunk_index[grid_chunk_slot(*this, last)]].occupied_index[grid_cell_in_chunk(last)] = occ_i;
+        occupied.pop_back();
+        occ_i = SLOT_NONE;
+    }
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "gameplay.hpp"
+#include "gen_vec.hpp"
+
+struct GridEntity {
+    GenKey key;
+    Tile tile;
+};
+
+inline constexpr u32 GRID_CHUNK_CELLS = LEVEL_CHUNK_SIZE * LEVEL_CHUNK_SIZE;
+
+// cells are laid out like in a level chunk, index x * LEVEL_CHUNK_SIZE + y
+struct GridChunk {
+    // the entities on a cell, packed at the front
+    array<array<GridEntity, CELL_SLOT_COUNT>, GRID_CHUNK_CELLS> cells;
+    array<u8, GRID_CHUNK_CELLS> counts;
+    array<u32, GRID_CHUNK_CELLS> occupied_index; // where the cell is in occupied, SLOT_NONE if it has no entities
+};
+
+// Which entities stand on which cell of the current level, so effects and queries only look at occupied
+//  cells instead of walking the whole plane. Built from a level once its tile entities have their entities,
+//  then kept in sync by feeding it the events of every move, which only re-reads the cells they touched.
+// Chunked like the level, only chunks that ever had an entity on them are allocated.
+struct EntityGrid {
+    u32 width;
+    u32 height;
+
+    vec<GridChunk> chunks;
+    vec<u32> chunk_index; // chunk x * chunks high + chunk y, index into chunks or SLOT_NONE
+
+    // cells with at least one entity, packed
+    vec<Coord> occupied;
+
+    // enough for build and apply_events on a level with chunk_count chunks out of chunk_slot_count, without
+    //  allocating
+    void reserve(u32 chunk_count, u32 chunk_slot_count, u32 occupied_count);
+    void build(const Level &level);
+    // re-reads the cells the moves in events went from and to
+    void apply_events(const Level &level, span<GameEvent> events);
+    span<const GridEntity> at(Coord c) const;
+    void clear();
+
+    void sync_cell(Coord c, const LevelCell &cell);
+};
@@ -1,9 +1,43 @@
 #include "gameplay.hpp"
 
+#include <algorithm>
+
 #include "utils.hpp"
 
 namespace {
 
+const u32 LEVEL_CHUNK_CELLS = LEVEL_CHUNK_SIZE * LEVEL_CHUNK_SIZE;
+
+const LevelCell empty_cell = {};
+
+u32 level_chunks_high(const Level &level) {
+    return (level.height + LEVEL_CHUNK_SIZE - 1) / LEVEL_CHUNK_SIZE;
+}
+
+// position of c's chunk in level.chunk_index. c has to be inside the level.
+u32 chunk_index_slot(const Level &level, Coord c) {
+    return ((u32)c.x / LEVEL_CHUNK_SIZE) * level_chunks_high(level) + (u32)c.y / LEVEL_CHUNK_SIZE;
+}
+
+// index into level.chunks of the chunk c is in, SLOT_NONE if it's outside the level or not allocated
+u32 level_find_chunk(const Level &level, Coord c) {
+    if (c.x < 0 || c.y < 0 || c.x >= (i32)level.width || c.y >= (i32)level.height) {
+        return SLOT_NONE;
+    }
+    return level.chunk_index[chunk_index_slot(level, c)];
+}
+
+// c's cell among the cells of all allocated chunks, for per cell scratch arrays that only cover what's allocated.
+// SLOT_NONE when the chunk isn't allocated.
+u32 level_cell_offset(const Level &level, Coord c) {
+    u32 chunk_i = level_find_chunk(level, c);
+    if (chunk_i == SLOT_NONE) {
+        return SLOT_NONE;
+    }
+    return chunk_i * LEVEL_CHUNK_CELLS + ((u32)c.x % LEVEL_CHUNK_SIZE) * LEVEL_CHUNK_SIZE +
+           (u32)c.y % LEVEL_CHUNK_SIZE;
+}
+
 u32 get_tile_priority(Tile t) {
     switch (t) {
     case Tile::Empty:
@@ -26,8 +60,6 @@ u32 get_tile_priority(Tile t) {
 
 void print_plane(const Level &level, i32 plane) {
 
-    auto const &p = level.data[plane];
-
     // gotta determine which one to show in the string.
     const auto cell_to_char = [](const LevelCell &lc) -> char {
         u32 max_priority = 0;
@@ -46,16 +78,11 @@ void print_plane(const Level &level, i32 plane) {
 
     vec<char> char_map((level.height) * (level.width + 1));
 
-    for (u32 col_i = 0; const auto &row : p) {
-        if (col_i >= level.width)
-            break;
-        for (u32 row_i = 0; const auto &cell : row) {
-            if (row_i >= level.height)
-                break;
+    for (u32 col_i = 0; col_i < level.width; ++col_i) {
+        for (u32 row_i = 0; row_i < level.height; ++row_i) {
+            const LevelCell &cell = level_cell(level, Coord{(i32)col_i, (i32)row_i});
             char_map[((level.width + 1) * row_i) + col_i] = cell_to_char(cell);
-            ++row_i;
         }
-        ++col_i;
     }
 
     for (u32 i = 1; auto &c : char_map) {
@@ -78,38 +105,17 @@ void print_plane(const Level &level, i32 plane) {
     }
 }
 
-Coord get_player_coord(const Level &level) {
-    for (u32 plane_i = 0; const auto &p : level.data) {
-        if (plane_i >= level.plane_count)
-            break;
-        for (i32 col_i = 0; const auto &column : p) {
-            for (i32 row_i = 0; const auto &cell : column) {
-                for (const auto &te : cell) {
-                    if (te.tile == Tile::Player) {
-                        return Coord{col_i, row_i};
-                    }
-                }
-                ++row_i;
-            }
-            ++col_i;
-        }
-        ++plane_i;
-    }
-    return Coord{};
-}
-
 bool level_query(const Level &level, Coord coord, LevelCell &c) {
     if (coord.x < 0 || coord.y < 0 || coord.x >= PLANE_MAX_WIDTH || coord.y >= PLANE_MAX_HEIGHT) {
         return false;
     }
 
-    c = level.data[0][coord.x][coord.y];
+    c = level_cell(level, coord);
     return true;
 }
 
 LevelCell &coord_get(Level &level, Coord c) {
-    LevelCell &lc = level.data[0][c.x][c.y];
-    return lc;
+    return level_cell_mut(level, c);
 }
 
 enum MoveDirection { Up, Right, Down, Left };
@@ -162,7 +168,7 @@ Coord coord_add(Coord c, MoveDirection dir) {
 }
 
 LevelCell coord_get_copy(const Level &level, Coord c) {
-    return level.data[0][c.x][c.y];
+    return level_cell(level, c);
 }
 
 bool coord_get_entity(const Level &level, Coord c, Tile tile, TileEntity &e) {
@@ -260,19 +266,57 @@ void level_find_player(const Level &level, Coord &out_c, TileEntity &out_te) {
     cell_get_entity(coord_get_copy(level, out_c), Tile::Player, out_te);
 }
 
-TileEntity &level_move_te(Level &level, TileEntity te, Coord c_from, Coord c_to) {
+// one level_move_te call, recorded so a move can be rolled back without copying the whole level
+struct MoveRecord {
+    TileEntity te_before;
+    Coord from;
+    Coord to;
+    u32 from_slot;
+    u32 to_slot;
+};
+
+// the longest push chain is a full row or column, plus the player
+inline constexpr u32 MOVE_JOURNAL_MAX = PLANE_MAX_WIDTH + PLANE_MAX_HEIGHT;
+
+struct MoveJournal {
+    array<MoveRecord, MOVE_JOURNAL_MAX> records;
+    u32 count;
+};
+
+// puts every moved tile entity back in the exact slot it came from, newest move first
+void journal_rollback(Level &level, MoveJournal &journal) {
+    while (journal.count > 0) {
+        const MoveRecord &rec = journal.records[--journal.count];
+
+        te_set_empty(coord_get(level, rec.to)[rec.to_slot]);
+        coord_get(level, rec.from)[rec.from_slot] = rec.te_before;
+
+        if (rec.te_before.tile == Tile::Player) {
+            level.player_hint = rec.from;
+        }
+    }
+}
+
+TileEntity &level_move_te(Level &level, TileEntity te, Coord c_from, Coord c_to, MoveJournal &journal) {
 
     // setting c_from slot to empty
     auto &cell_from = coord_get(level, c_from);
 
     bool found = false;
 
-    for (auto &te_i : cell_from) {
+    MoveRecord rec = {};
+    rec.from = c_from;
+    rec.to = c_to;
+
+    for (u32 slot = 0; auto &te_i : cell_from) {
         if (te_i.id == te.id) {
+            rec.te_before = te_i;
+            rec.from_slot = slot;
             te_set_empty(te_i);
             found = true;
             break;
         }
+        ++slot;
     }
 
     lassert(found);
@@ -281,6 +325,14 @@ TileEntity &level_move_te(Level &level, TileEntity te, Coord c_from, Coord c_to)
     auto &cell_to = coord_get(level, c_to);
     TileEntity &te_ret = cell_place(cell_to, te);
 
+    rec.to_slot = (u32)(&te_ret - &cell_to[0]);
+    lassert(journal.count < journal.records.size());
+    journal.records[journal.count++] = rec;
+
+    if (te.tile == Tile::Player) {
+        level.player_hint = c_to;
+    }
+
     return te_ret;
 }
 
@@ -476,7 +528,7 @@ done_searching:
     return true;
 }
 
-bool try_mirror_teleport(Level &level, TileEntity te, Coord c, vec<GameEvent> &events) {
+bool try_mirror_teleport(Level &level, TileEntity te, Coord c, vec<GameEvent> &events, MoveJournal &journal) {
 
     TileEntity telep;
     Coord telep_coord;
@@ -507,7 +559,7 @@ bool try_mirror_teleport(Level &level, TileEntity te, Coord c, vec<GameEvent> &e
     }
 
     // move player
-    level_move_te(level, te, c, destination);
+    level_move_te(level, te, c, destination, journal);
 
     return true;
 }
@@ -515,18 +567,19 @@ bool try_mirror_teleport(Level &level, TileEntity te, Coord c, vec<GameEvent> &e
 // step logic here. it moves the thing to the next direction if is a possible valid move
 // if there's a (moveable) there, out_keep_stepping is set to true
 // out_is_valid_move is only meaningful when out_keep_stepping is false.
-StepResult try_move_step(Level &level, TileEntity te, Coord c, Direction dir, vec<GameEvent> &events) {
+StepResult try_move_step(Level &level, TileEntity te, Coord c, Direction dir, vec<GameEvent> &events,
+                         MoveJournal &journal) {
 
     // this is in the step
 
-    Coord coord_ahead = c;
+    Coord coord_ahead = coord_step(c, dir);
 
     StepResult res = {};
     res.is_done = true;
 
     // this one is special
     if (dir == Direction::JumpAction) {
-        bool did_jump = try_mirror_teleport(level, te, c, events);
+        bool did_jump = try_mirror_teleport(level, te, c, events, journal);
 
         res.is_done = true;
         res.is_valid = did_jump;
@@ -534,22 +587,6 @@ StepResult try_move_step(Level &level, TileEntity te, Coord c, Direction dir, ve
         return res;
     }
 
-    // get the coord ahead
-    switch (dir) {
-    case Direction::Left:
-        --coord_ahead.x;
-        break;
-    case Direction::Right:
-        ++coord_ahead.x;
-        break;
-    case Direction::Up:
-        ++coord_ahead.y;
-        break;
-    case Direction::Down:
-        --coord_ahead.y;
-        break;
-    }
-
     if (!coord_is_valid(level, coord_ahead)) {
         res.is_done = true;
         res.is_valid = false;
@@ -570,7 +607,7 @@ StepResult try_move_step(Level &level, TileEntity te, Coord c, Direction dir, ve
             ev.te = te;
             events.push_back(ev);
 
-            TileEntity &moved = level_move_te(level, te, c, coord_ahead);
+            TileEntity &moved = level_move_te(level, te, c, coord_ahead, journal);
             moved.tile = Tile::Floor;
             res.is_done = true;
             res.is_valid = true;
@@ -588,7 +625,7 @@ StepResult try_move_step(Level &level, TileEntity te, Coord c, Direction dir, ve
             ev.kind = EventKind::PlayerFall;
             events.push_back(ev);
 
-            level_move_te(level, te, c, coord_ahead);
+            level_move_te(level, te, c, coord_ahead, journal);
 
             res.is_done = true;
             res.is_valid = true;
@@ -606,7 +643,7 @@ StepResult try_move_step(Level &level, TileEntity te, Coord c, Direction dir, ve
         ev.to = coord_ahead;
         ev.te = te;
         events.push_back(ev);
-        level_move_te(level, te, c, coord_ahead);
+        level_move_te(level, te, c, coord_ahead, journal);
 
         res.is_done = true;
         res.is_valid = true;
@@ -623,7 +660,7 @@ StepResult try_move_step(Level &level, TileEntity te, Coord c, Direction dir, ve
         ev.to = coord_ahead;
         ev.te = te;
         events.push_back(ev);
-        level_move_te(level, te, c, coord_ahead);
+        level_move_te(level, te, c, coord_ahead, journal);
 
         res.next_coord = coord_ahead;
         res.next_te = next_te;
@@ -639,15 +676,15 @@ StepResult try_move_step(Level &level, TileEntity te, Coord c, Direction dir, ve
     }
 }
 
-void level_play_move(const Level &level, Direction dir, Level &new_level, vec<GameEvent> &events) {
+// plays the move in place, recording what it moves in the empty journal. if the move is not valid, the level,
+//  events and journal are left untouched.
+bool level_play_move_journaled(Level &level, Direction dir, vec<GameEvent> &events, MoveJournal &journal) {
 
     Coord p_c = get_player_coord(level);
     TileEntity player;
     assert(coord_get_entity(level, p_c, Tile::Player, player));
 
-    // allocate level copy and events copy so they can be easily reversed
-    auto lvl_copy = std::make_unique<Level>(level);
-    vec<GameEvent> new_events = {};
+    u64 events_start = events.size();
 
     StepResult s_res = {};
     s_res.is_done = false;
@@ -655,45 +692,100 @@ void level_play_move(const Level &level, Direction dir, Level &new_level, vec<Ga
     s_res.next_te = player;
 
     while (!s_res.is_done) {
-        s_res = try_move_step(*lvl_copy, s_res.next_te, s_res.next_coord, dir, new_events);
+        s_res = try_move_step(level, s_res.next_te, s_res.next_coord, dir, events, journal);
     }
 
-    if (s_res.is_valid) {
-        new_level = *lvl_copy;
+    if (!s_res.is_valid) {
+        journal_rollback(level, journal);
+        events.resize(events_start);
+    }
 
-        // check if it can mirror now
-        p_c = get_player_coord(new_level);
+    return s_res.is_valid;
+}
 
-        bool it_fell = false;
-        for (const auto &ev : new_events) {
-            if (ev.kind == EventKind::PlayerFall) {
-                it_fell = true;
-                break;
-            }
-        }
+// plays the move in place. if the move is not valid, the level and events are left untouched.
+bool level_play_move(Level &level, Direction dir, vec<GameEvent> &events) {
+    // only the count needs clearing, a full journal is big with 1024 wide planes
+    MoveJournal journal;
+    journal.count = 0;
+    return level_play_move_journaled(level, dir, events, journal);
+}
+
+void level_play_moves(Level &level, const Level &level_start, span<Direction> moves) {
+    level = level_start;
+
+    vec<GameEvent> events = {};
+    events.reserve(10);
 
-        events.insert(events.end(), new_events.begin(), new_events.end());
+    for (auto move : moves) {
+        events.clear();
+        level_play_move(level, move, events);
     }
 }
 
-Level level_play_moves(const Level &level, span<Direction> moves) {
-    Level lvl = level;
+// 3, 4 and 5 from level_find_invariant_violation, for a single cell
+const char *cell_find_invariant_violation(const LevelCell &cell) {
+    u32 used = 0;
+    u32 floors = 0;
+    u32 moveables = 0;
 
-    vec<GameEvent> events(5);
+    for (const auto &te : cell) {
+        if ((te.id == 0) != (te.tile == Tile::Empty)) {
+            return te.id == 0 ? "tile with id 0 is not an empty" : "empty with a non-zero id";
+        }
 
-    for (auto move : moves) {
-        Level new_lvl;
-        level_play_move(lvl, move, new_lvl, events);
-        lvl = new_lvl;
+        if (te.tile == Tile::Empty) {
+            continue;
+        }
+
+        ++used;
+
+        if (te.tile == Tile::Floor) {
+            ++floors;
+        }
+        if (is_tile_moveable(te.tile)) {
+            ++moveables;
+        }
     }
 
-    return lvl;
+    if (floors > 1) {
+        return "more than one floor in a cell";
+    }
+    if (moveables > 1) {
+        return "more than one moveable in a cell";
+    }
+    if (used >= CELL_SLOT_COUNT) {
+        return "cell has no free slot";
+    }
+
+    return 0;
 }
 
 } // namespace
 
 // --------------------------------- EXPORTED FUNCTIONS (START) ---------------------------------
 
+Coord coord_step(Coord c, Direction dir) {
+    switch (dir) {
+    case Direction::Left:
+        --c.x;
+        break;
+    case Direction::Right:
+        ++c.x;
+        break;
+    case Direction::Up:
+        ++c.y;
+        break;
+    case Direction::Down:
+        --c.y;
+        break;
+    case Direction::JumpAction:
+        break;
+    }
+
+    return c;
+}
+
 void game_do_reset(Level &level, const Level &level_start, vec<Direction> &moves) {
     level = level_start;
     moves.clear();
@@ -706,44 +798,40 @@ void game_do_undo(Level &level, const Level &level_start, vec<Direction> &moves)
     }
 
     moves.pop_back();
-    level = level_play_moves(level_start, moves);
+    level_play_moves(level, level_start, moves);
     return;
 }
 
-void game_tick(Direction dir, Level &level, const Level &level_start, vec<Direction> &moves, vec<GameEvent> &eks) {
-
-    // tile of where the player wants to go
-    Level level_next;
-    level_play_move(level, dir, level_next, eks);
+void game_do_undo(Level &level, const Level &level_start, vec<Direction> &moves, vec<GameEvent> &out_events) {
+    out_events.clear();
 
-    if (eks.size() == 0) {
+    if (moves.size() <= 0) {
         return;
     }
 
-    // print_plane(level_next, 0);
+    Direction undone = moves.back();
+    game_do_undo(level, level_start, moves);
+
+    // playing the undone move once more for its events, then taking it back
+    MoveJournal journal;
+    journal.count = 0;
+    level_play_move_journaled(level, undone, out_events, journal);
+    journal_rollback(level, journal);
+}
 
-    level = level_next;
+void game_tick(Direction dir, Level &level, const Level &level_start, vec<Direction> &moves, vec<GameEvent> &eks) {
+
+    if (!level_play_move(level, dir, eks)) {
+        return;
+    }
+
+    // print_plane(level, 0);
 
     // add the move
     moves.push_back(dir);
 
-    // check for win state
-    bool is_win = false;
-
-    for (u32 plane_i = 0; const auto &p : level.data) {
-        if (plane_i >= level.plane_count)
-            break;
-        for (const auto &column : p) {
-            for (const auto &cell : column) {
-                if (cell_is_there(cell, Tile::Goal) && (cell_is_there(cell, Tile::Player))) {
-                    is_win = true;
-                    goto outer;
-                }
-            }
-        }
-        ++plane_i;
-    }
-outer:
+    // check for win state. there is only one player so only its cell can be a win.
+    bool is_win = cell_is_there(coord_get(level, get_player_coord(level)), Tile::Goal);
 
     if (is_win) {
         GameEvent ev = {};
@@ -836,27 +924,128 @@ bool is_teleport(span<GameEvent> events) {
     return is_teleport;
 }
 
-// 1 - make sure there is only one player
-// 2 - make sure all ids are unique except id 0 which should be an empty
-// 3 - all id 0 should be empty
-// 4 - all empty should be id 0
-void do_level_sanity_checks(const Level &level) {
+// 1 - there is exactly one player
+// 2 - all ids are unique except id 0, which is only for empties
+// 3 - all id 0 are empty and all empties are id 0
+// 4 - a cell has at most one floor and one moveable
+// 5 - every cell keeps a free slot, so cell_place into it can't overflow CELL_SLOT_COUNT
+// 6 - nothing lives outside of width x height. the part of the edge chunks past the bounds is checked.
+// 7 - every allocated chunk is where the chunk index says
+const char *level_find_invariant_violation(const Level &level) {
+
+    if (level.width > PLANE_MAX_WIDTH || level.height > PLANE_MAX_HEIGHT) {
+        return "level is bigger than the plane";
+    }
+
+    if (level.chunk_origins.size() != level.chunks.size()) {
+        return "chunk without an origin";
+    }
 
     u32 players = 0;
 
-    for (const auto &row : level.data[0]) {
-        for (const auto &cell : row) {
-            for (const auto &te : cell) {
-                if (te.tile == Tile::Player) {
-                    ++players;
+    vec<u32> ids = {};
+
+    for (u32 chunk_i = 0; chunk_i < level.chunks.size(); ++chunk_i) {
+        Coord origin = level.chunk_origins[chunk_i];
+
+        if (level_find_chunk(level, origin) != chunk_i) {
+            return "chunk is not where the chunk index says";
+        }
+
+        for (u32 x = 0; x < LEVEL_CHUNK_SIZE; ++x) {
+            for (u32 y = 0; y < LEVEL_CHUNK_SIZE; ++y) {
+                const auto &cell = level.chunks[chunk_i][x][y];
+
+                if (origin.x + x >= level.width || origin.y + y >= level.height) {
+                    if (!cell_is_empty(cell)) {
+                        return "tile outside of the level bounds";
+                    }
+                    continue;
                 }
+
+                if (const char *violation = cell_find_invariant_violation(cell)) {
+                    return violation;
+                }
+
+                for (const auto &te : cell) {
+                    if (te.tile == Tile::Empty) {
+                        continue;
+                    }
+
+                    ids.push_back(te.id);
+
+                    if (te.tile == Tile::Player) {
+                        ++players;
+                    }
+                }
+            }
+        }
+    }
+
+    if (players != 1) {
+        return "there is not exactly one player";
+    }
+
+    std::sort(ids.begin(), ids.end());
+    if (std::adjacent_find(ids.begin(), ids.end()) != ids.end()) {
+        return "duplicate tile entity id";
+    }
+
+    return 0;
+}
+
+// only checks 3, 4 and 5 on the cells the events touched, and that the player is where the events say
+const char *level_find_cell_invariant_violation(const Level &level, span<GameEvent> events) {
+
+    if (level.width > PLANE_MAX_WIDTH || level.height > PLANE_MAX_HEIGHT) {
+        return "level is bigger than the plane";
+    }
+
+    // a walk has a move per step but only the last one says where the player ended up, so the events are
+    //  looked at newest first and only the first player move is checked
+    bool player_checked = false;
+
+    for (u64 i = events.size(); i-- > 0;) {
+        const GameEvent &ev = events[i];
+
+        if (ev.kind == EventKind::Won) {
+            continue;
+        }
+
+        for (Coord c : {ev.from, ev.to}) {
+            if (!coord_is_valid(level, c)) {
+                continue;
+            }
+            if (const char *violation = cell_find_invariant_violation(coord_get_copy(level, c))) {
+                return violation;
+            }
+        }
+
+        bool is_player_move = ev.kind == EventKind::NormalMove || ev.kind == EventKind::MirrorTeleport;
+        if (is_player_move && ev.te.tile == Tile::Player && !player_checked) {
+            player_checked = true;
+            if (!coord_is_valid(level, ev.to)) {
+                continue;
+            }
+
+            TileEntity player = {};
+            if (!coord_get_entity(level, ev.to, Tile::Player, player) || player.id != ev.te.id) {
+                return "player is not where the move put it";
             }
         }
     }
 
-    lassert(players == 1);
+    return 0;
+}
+
+void do_level_sanity_checks_full(const Level &level) {
+    const char *violation = level_find_invariant_violation(level);
+    lassert_s(violation == 0, violation);
+}
 
-    // TODO(lucy): more checks
+void do_level_sanity_checks_cheap(const Level &level, span<GameEvent> events) {
+    const char *violation = level_find_cell_invariant_violation(level, events);
+    lassert_s(violation == 0, violation);
 }
 
 bool is_tile_moveable(Tile tile) {
@@ -874,6 +1063,157 @@ bool is_tile_moveable(Tile tile) {
     return false;
 }
 
+// BFS over the cells the player can walk into without pushing anything.
+// goal cells end the search on that branch, because stepping on them wins the level.
+bool game_find_path(const Level &level, Coord to, vec<Direction> &out_path) {
+    out_path.clear();
+
+    if (!coord_is_valid(level, to)) {
+        return false;
+    }
+
+    Coord from = get_player_coord(level);
+
+    if (from.x == to.x && from.y == to.y) {
+        return false;
+    }
+
+    if (!cell_is_free_with_floor(coord_get_copy(level, to))) {
+        return false;
+    }
+
+    const array<Direction, 4> directions = {Direction::Left, Direction::Right, Direction::Up, Direction::Down};
+
+    // direction used to enter each cell (by level_cell_offset). -1 means not visited yet.
+    // a walk only crosses floors, and those are always in allocated chunks.
+    vec<i8> came_from(level.chunks.size() * LEVEL_CHUNK_CELLS, -1);
+
+    vec<Coord> queue = {};
+    u32 queue_head = 0;
+
+    queue.push_back(from);
+    came_from[level_cell_offset(level, from)] = (i8)Direction::JumpAction;
+
+    bool found = false;
+
+    while (queue_head < queue.size()) {
+        Coord c = queue[queue_head++];
+
+        if (c.x == to.x && c.y == to.y) {
+            found = true;
+            break;
+        }
+
+        if (cell_is_there(coord_get_copy(level, c), Tile::Goal)) {
+            continue;
+        }
+
+        for (auto dir : directions) {
+            Coord next = coord_step(c, dir);
+
+            u32 next_i = level_cell_offset(level, next);
+
+            if (next_i == SLOT_NONE || came_from[next_i] != -1) {
+                continue;
+            }
+
+            if (!cell_is_free_with_floor(level_cell(level, next))) {
+                continue;
+            }
+
+            came_from[next_i] = (i8)dir;
+            queue.push_back(next);
+        }
+    }
+
+    if (!found) {
+        return false;
+    }
+
+    // walking back from the destination
+    Coord c = to;
+    while (c.x != from.x || c.y != from.y) {
+        Direction dir = (Direction)came_from[level_cell_offset(level, c)];
+        out_path.push_back(dir);
+
+        switch (dir) {
+        case Direction::Left:
+            ++c.x;
+            break;
+        case Direction::Right:
+            --c.x;
+            break;
+        case Direction::Up:
+            --c.y;
+            break;
+        case Direction::Down:
+            ++c.y;
+            break;
+        case Direction::JumpAction:
+            lassert(false);
+            break;
+        }
+    }
+
+    std::reverse(out_path.begin(), out_path.end());
+
+    return true;
+}
+
+// plays a path from game_find_path as a single tick. the player is moved once to the end of the path,
+//  but a NormalMove event is still emitted per step so the path can be animated.
+// every direction is pushed to `moves` so undo keeps working step by step.
+void game_tick_path(span<Direction> path, Level &level, const Level &level_start, vec<Direction> &moves,
+                    vec<GameEvent> &eks) {
+
+    if (path.size() == 0) {
+        return;
+    }
+
+    Coord p_c;
+    TileEntity player;
+    level_find_player(level, p_c, player);
+
+    Coord c = p_c;
+
+    for (auto dir : path) {
+        Coord next = coord_step(c, dir);
+
+        // paths are only valid for the level state they were searched on
+        if (!coord_is_valid(level, next) || !cell_is_free_with_floor(coord_get_copy(level, next))) {
+            break;
+        }
+
+        GameEvent ev = {};
+        ev.kind = EventKind::NormalMove;
+        ev.from = c;
+        ev.to = next;
+        ev.te = player;
+        eks.push_back(ev);
+
+        moves.push_back(dir);
+        c = next;
+
+        if (cell_is_there(coord_get_copy(level, c), Tile::Goal)) {
+            break;
+        }
+    }
+
+    if (c.x == p_c.x && c.y == p_c.y) {
+        return;
+    }
+
+    MoveJournal journal;
+    journal.count = 0;
+    level_move_te(level, player, p_c, c, journal);
+
+    if (cell_is_there(coord_get_copy(level, c), Tile::Goal)) {
+        GameEvent ev = {};
+        ev.kind = EventKind::Won;
+        eks.push_back(ev);
+    }
+}
+
 bool game_get_mirror_preview(const Level &level, MirrorPreviewData &out_preview) {
     TileEntity telep;
     Coord telep_coord;
@@ -893,30 +1233,65 @@ bool game_get_mirror_preview(const Level &level, MirrorPreviewData &out_preview)
     return false;
 }
 
+// the goal the player is standing on, only meaningful once the level is won
 Coord get_goal_coord(const Level &level) {
-    for (u32 plane_i = 0; const auto &p : level.data) {
-        if (plane_i >= level.plane_count)
-            break;
-        for (i32 col_i = 0; const auto &column : p) {
-            for (i32 row_i = 0; const auto &cell : column) {
-                bool has_player = false;
-                bool has_goal = false;
-                for (const auto &te : cell) {
-                    if (te.tile == Tile::Goal) {
-                        has_goal = true;
-                    }
-                    if (te.tile == Tile::Player) {
-                        has_player = true;
-                    }
-                }
-                if (has_player && has_goal) {
-                    return Coord{col_i, row_i};
-                }
-                ++row_i;
-            }
-            ++col_i;
-        }
-        ++plane_i;
+    Coord c = get_player_coord(level);
+
+    if (cell_is_there(level_cell(level, c), Tile::Goal)) {
+        return c;
     }
     return Coord{};
-}
\ No newline at end of file
+}
+
+// the hint is right after any move, so the scan only runs on levels nothing has moved in yet
+Coord get_player_coord(const Level &level) {
+    if (cell_is_there(level_cell(level, level.player_hint), Tile::Player)) {
+        return level.player_hint;
+    }
+
+    Coord res = {};
+    level_for_each_cell(level, [&res](Coord c, const LevelCell &cell) {
+        if (cell_is_there(cell, Tile::Player)) {
+            res = c;
+        }
+    });
+    return res;
+}
+
+void level_init(Level &level, u32 width, u32 height) {
+    lassert(width <= PLANE_MAX_WIDTH && height <= PLANE_MAX_HEIGHT);
+
+    level.width = width;
+    level.height = height;
+    level.plane_count = 1;
+    level.player_hint = Coord{};
+
+    level.chunks.clear();
+    level.chunk_origins.clear();
+
+    u32 chunks_wide = (width + LEVEL_CHUNK_SIZE - 1) / LEVEL_CHUNK_SIZE;
+    level.chunk_index.assign(chunks_wide * level_chunks_high(level), SLOT_NONE);
+}
+
+const LevelCell &level_cell(const Level &level, Coord c) {
+    u32 chunk_i = level_find_chunk(level, c);
+    if (chunk_i == SLOT_NONE) {
+        return empty_cell;
+    }
+    return level.chunks[chunk_i][(u32)c.x % LEVEL_CHUNK_SIZE][(u32)c.y % LEVEL_CHUNK_SIZE];
+}
+
+LevelCell &level_cell_mut(Level &level, Coord c) {
+    lassert(coord_is_valid(level, c));
+
+    u32 &chunk_i = level.chunk_index[chunk_index_slot(level, c)];
+
+    if (chunk_i == SLOT_NONE) {
+        chunk_i = (u32)level.chunks.size();
+        level.chunks.emplace_back();
+        level.chunk_origins.push_back(Coord{(i32)((u32)c.x / LEVEL_CHUNK_SIZE * LEVEL_CHUNK_SIZE),
+                                            (i32)((u32)c.y / LEVEL_CHUNK_SIZE * LEVEL_CHUNK_SIZE)});
+    }
+
+    return level.chunks[chunk_i][(u32)c.x % LEVEL_CHUNK_SIZE][(u32)c.y % LEVEL_CHUNK_SIZE];
+}
@@ -31,19 +31,27 @@ struct Coord {
 inline constexpr u32 CELL_SLOT_COUNT = 4;
 
 inline constexpr u32 PLANE_MAX_COUNT = 1;
-inline constexpr u32 PLANE_MAX_WIDTH = 30;
-inline constexpr u32 PLANE_MAX_HEIGHT = 30;
+inline constexpr u32 PLANE_MAX_WIDTH = 1024;
+inline constexpr u32 PLANE_MAX_HEIGHT = 1024;
+
+// cells are stored in square chunks, and a chunk is only allocated once something is placed in it
+inline constexpr u32 LEVEL_CHUNK_SIZE = 16;
 
 using LevelCell = array<TileEntity, CELL_SLOT_COUNT>;
-using LevelPlane = array<array<LevelCell, PLANE_MAX_HEIGHT>, PLANE_MAX_WIDTH>;
-using LevelData = array<LevelPlane, PLANE_MAX_COUNT>;
+using LevelChunk = array<array<LevelCell, LEVEL_CHUNK_SIZE>, LEVEL_CHUNK_SIZE>;
 
-// level data + info on size of things and possibly other things
+// level data + info on size of things and possibly other things.
+// big levels are mostly empty, so only the chunks that have something in them take memory, and code that
+//  has to look at every tile entity walks the allocated chunks (level_for_each_cell) instead of width x height.
 struct Level {
-    LevelData data;
+    vec<LevelChunk> chunks;
+    vec<Coord> chunk_origins; // coord of the first cell of chunks[i]
+    // per chunk of the level (chunk x * chunks high + chunk y), index into chunks or SLOT_NONE
+    vec<u32> chunk_index;
     u32 plane_count;
     u32 width;
     u32 height;
+    Coord player_hint; // where moves last put the player. checked before it's trusted.
 };
 
 struct LevelNamed {
@@ -76,8 +84,47 @@ struct MirrorPreviewData {
 
 enum struct Direction { Left, Right, Up, Down, JumpAction };
 
+// empties the level and sets its size. no chunk is allocated until something is placed.
+void level_init(Level &level, u32 width, u32 height);
+// c one cell towards dir: Up is +y, Right is +x. JumpAction doesn't move.
+Coord coord_step(Coord c, Direction dir);
+// the cell at c. cells outside the level or in chunks that were never allocated are empty.
+const LevelCell &level_cell(const Level &level, Coord c);
+// the cell at c, allocating its chunk if needed. c has to be inside the level. allocating a chunk can move the
+//  others, so references from earlier calls go stale.
+LevelCell &level_cell_mut(Level &level, Coord c);
+
+// calls f(Coord, LevelCell &) on every cell inside the level that is in an allocated chunk, chunk by chunk.
+// the cells it skips are all empty.
+template <typename L, typename F>
+void level_for_each_cell(L &level, F f) {
+    for (u64 chunk_i = 0; chunk_i < level.chunks.size(); ++chunk_i) {
+        auto &chunk = level.chunks[chunk_i];
+        Coord origin = level.chunk_origins[chunk_i];
+
+        // chunks on the far edges can stick out of the level
+        u32 w = level.width - (u32)origin.x;
+        u32 h = level.height - (u32)origin.y;
+        w = w < LEVEL_CHUNK_SIZE ? w : LEVEL_CHUNK_SIZE;
+        h = h < LEVEL_CHUNK_SIZE ? h : LEVEL_CHUNK_SIZE;
+
+        for (u32 x = 0; x < w; ++x) {
+            for (u32 y = 0; y < h; ++y) {
+                f(Coord{origin.x + (i32)x, origin.y + (i32)y}, chunk[x][y]);
+            }
+        }
+    }
+}
+
 void game_tick(Direction dir, Level &level, const Level &level_start, vec<Direction> &moves, vec<GameEvent> &eks);
+// finds the shortest walk to `to` that doesn't push anything. false if there is none.
+bool game_find_path(const Level &level, Coord to, vec<Direction> &out_path);
+void game_tick_path(span<Direction> path, Level &level, const Level &level_start, vec<Direction> &moves,
+                    vec<GameEvent> &eks);
 void game_do_undo(Level &level, const Level &level_start, vec<Direction> &moves);
+// like game_do_undo, and out_events gets the events of the move it took back. every cell the undo changed is where
+//  one of them went from or to.
+void game_do_undo(Level &level, const Level &level_start, vec<Direction> &moves, vec<GameEvent> &out_events);
 void game_do_reset(Level &level, const Level &level_start, vec<Direction> &moves);
 TileEntity &cell_place(LevelCell &cell, TileEntity te);
 bool cell_is_empty(const LevelCell &cell);
@@ -85,7 +132,33 @@ bool is_game_over(span<GameEvent> events);
 bool is_game_won(span<GameEvent> events);
 bool is_move(span<GameEvent> events);
 bool is_teleport(span<GameEvent> events);
-void do_level_sanity_checks(const Level &level);
+// first broken level invariant, or 0 if there is none. scans the whole level.
+const char *level_find_invariant_violation(const Level &level);
+// per cell invariants, only for the cells the events touched
+const char *level_find_cell_invariant_violation(const Level &level, span<GameEvent> events);
+void do_level_sanity_checks_full(const Level &level);
+void do_level_sanity_checks_cheap(const Level &level, span<GameEvent> events);
 bool is_tile_moveable(Tile tile);
 bool game_get_mirror_preview(const Level &level, MirrorPreviewData &out_preview);
-Coord get_goal_coord(const Level &level);
\ No newline at end of file
+Coord get_goal_coord(const Level &level);
+Coord get_player_coord(const Level &level);
+// how much checking do_level_sanity_checks does, picked per build.
+// Off: nothing. Cheap: only the cells the last move touched. Full: the whole level, after every move.
+enum struct SanityChecks { Off, Cheap, Full };
+
+#if defined(_DEBUG) || defined(PSYCHOBOX_SANITY_FULL)
+inline constexpr SanityChecks SANITY_CHECKS = SanityChecks::Full;
+#elif defined(PSYCHOBOX_SANITY_CHEAP)
+inline constexpr SanityChecks SANITY_CHECKS = SanityChecks::Cheap;
+#else
+inline constexpr SanityChecks SANITY_CHECKS = SanityChecks::Off;
+#endif
+
+template <SanityChecks checks = SANITY_CHECKS>
+void do_level_sanity_checks(const Level &level, span<GameEvent> events = {}) {
+    if constexpr (checks == SanityChecks::Full) {
+        do_level_sanity_checks_full(level);
+    } else if constexpr (checks == SanityChecks::Cheap) {
+        do_level_sanity_checks_cheap(level, events);
+    }
+}
@@ -1,5 +1,7 @@
 #include "gen_vec.hpp"
 
-bool genkey_eq(GenKey a, GenKey b) {
-    return a.index == b.index && a.gen == b.gen;
-}
\ No newline at end of file
+#include "utils.hpp"
+
+void genvec_assert_failed() {
+    lassert(false);
+}
@@ -1,18 +1,57 @@
 #pragma once
 
+#include <bit>
+#include <xmmintrin.h>
+
 #include "lucytypes.hpp"
 
+// lassert for this header. utils.hpp pulls in windows.h, so the failure is handled out of line in gen_vec.cpp.
+void genvec_assert_failed();
+#define genvec_assert(expr)                                                                                        \
+    if (!(expr))                                                                                                   \
+        genvec_assert_failed();
+
+// GenKey fits in 32 bits: the low GENKEY_INDEX_BITS are the index and the rest is the generation.
+// gens wrap around, so a stale key only aliases a live one after 2^GENKEY_GEN_BITS reuses of its slot.
+inline constexpr u32 GENKEY_INDEX_BITS = 20;
+inline constexpr u32 GENKEY_GEN_BITS = 32 - GENKEY_INDEX_BITS;
+inline constexpr u32 GENKEY_INDEX_MAX = (1u << GENKEY_INDEX_BITS) - 1;
+inline constexpr u32 GENKEY_GEN_MASK = (1u << GENKEY_GEN_BITS) - 1;
+
 struct GenKey {
-    u64 index;
-    u64 gen;
+    u32 index : GENKEY_INDEX_BITS;
+    u32 gen : GENKEY_GEN_BITS;
 };
 
-bool genkey_eq(GenKey a, GenKey b);
+static_assert(sizeof(GenKey) == sizeof(u32));
+
+inline bool genkey_eq(GenKey a, GenKey b) {
+    return std::bit_cast<u32>(a) == std::bit_cast<u32>(b);
+}
+
+inline GenKey genkey_make(u64 index, u32 gen) {
+    genvec_assert(index <= GENKEY_INDEX_MAX);
+    GenKey key = {};
+    key.index = (u32)index;
+    key.gen = gen & GENKEY_GEN_MASK;
+    return key;
+}
+
+inline u32 genkey_next_gen(u32 gen) {
+    return (gen + 1) & GENKEY_GEN_MASK;
+}
+
+// how many keys ahead get_many prefetches
+inline constexpr u64 GENVEC_PREFETCH_DISTANCE = 8;
+
+inline void genvec_prefetch(const void *p) {
+    _mm_prefetch((const char *)p, _MM_HINT_T0);
+}
 
 template <typename T>
 struct GenEntry {
     T entry;
-    u64 gen;
+    u32 gen;
     bool live;
 };
 
@@ -21,7 +60,11 @@ struct GenVec {
     vec<GenEntry<T>> things;
     vec<u64> free_indices;
 
+    // 0 if the key is stale or out of range
     T *get(GenKey k) {
+        if (k.index >= things.size()) {
+            return 0;
+        }
         auto *ge = &things[k.index];
         if (ge->gen == k.gen) {
             return &ge->entry;
@@ -29,6 +72,21 @@ struct GenVec {
         return 0;
     }
 
+    // out[i] = get(keys[i]), prefetching the entries a few keys ahead
+    void get_many(span<const GenKey> keys, span<T *> out) {
+        genvec_assert(out.size() >= keys.size());
+
+        for (u64 i = 0; i < keys.size(); ++i) {
+            if (i + GENVEC_PREFETCH_DISTANCE < keys.size()) {
+                u32 ahead = keys[i + GENVEC_PREFETCH_DISTANCE].index;
+                if (ahead < things.size()) {
+                    genvec_prefetch(&things[ahead]);
+                }
+            }
+            out[i] = get(keys[i]);
+        }
+    }
+
     void remove(GenKey k) {
 
         if (things.size() <= k.index)
@@ -37,7 +95,7 @@ struct GenVec {
         if (things[k.index].gen != k.gen)
             return;
 
-        ++things[k.index].gen;
+        things[k.index].gen = genkey_next_gen(things[k.index].gen);
         things[k.index].live = false;
         free_indices.push_back(k.index);
     }
@@ -48,20 +106,14 @@ struct GenVec {
             free_indices.pop_back();
             things[index].entry = entry;
             things[index].live = true;
-            GenKey key = {};
-            key.index = index;
-            key.gen = things[index].gen;
-            return key;
+            return genkey_make(index, things[index].gen);
         }
         GenEntry<T> ge = {};
         ge.entry = entry;
         ge.gen = 0;
         ge.live = true;
         things.push_back(ge);
-        GenKey key = {};
-        key.index = things.size() - 1;
-        key.gen = 0;
-        return key;
+        return genkey_make(things.size() - 1, 0);
     }
 
     // safe way to "clear"
@@ -70,7 +122,7 @@ struct GenVec {
         free_indices.reserve(things.size());
 
         for (u64 i = 0; auto &ge : things) {
-            ++ge.gen;
+            ge.gen = genkey_next_gen(ge.gen);
             ge.live = false;
             free_indices.push_back(i);
             ++i;
@@ -82,3 +134,196 @@ struct GenVec {
         free_indices.clear();
     }
 };
+
+struct SlotEntry {
+    u32 value_index;
+    u32 gen;
+    bool live;
+};
+
+inline constexpr u32 SLOT_NONE = 0xFFFFFFFF;
+
+// The key -> packed index part of a slot map, for containers that keep their values in one or more packed arrays.
+// The owner appends a value when add is called, and when remove says so, moves its last value into the hole
+//  and pops.
+struct SlotTable {
+    vec<u32> value_slots; // value_slots[i] is the slot that points at value i
+    vec<SlotEntry> slots;
+    vec<u32> free_slots;
+
+    u32 count() const {
+        return (u32)value_slots.size();
+    }
+
+    // packed index of the key's value, SLOT_NONE if the key is stale or out of range
+    u32 find(GenKey k) const {
+        if (k.index >= slots.size()) {
+            return SLOT_NONE;
+        }
+        const SlotEntry &se = slots[k.index];
+        if (se.gen == k.gen && se.live) {
+            return se.value_index;
+        }
+        return SLOT_NONE;
+    }
+
+    // out[i] = find(keys[i]), prefetching the slots a few keys ahead
+    void find_many(span<const GenKey> keys, span<u32> out) const {
+        genvec_assert(out.size() >= keys.size());
+
+        for (u64 i = 0; i < keys.size(); ++i) {
+            if (i + GENVEC_PREFETCH_DISTANCE < keys.size()) {
+                u32 ahead = keys[i + GENVEC_PREFETCH_DISTANCE].index;
+                if (ahead < slots.size()) {
+                    genvec_prefetch(&slots[ahead]);
+                }
+            }
+            out[i] = find(keys[i]);
+        }
+    }
+
+    // key of the value at value_index, for removing while iterating
+    GenKey key_of(u32 value_index) const {
+        u32 slot_index = value_slots[value_index];
+        return genkey_make(slot_index, slots[slot_index].gen);
+    }
+
+    // the owner has to append the new value, it lives at the old count()
+    GenKey add() {
+        u32 slot_index;
+
+        if (free_slots.size() > 0) {
+            slot_index = free_slots.back();
+            free_slots.pop_back();
+        } else {
+            genvec_assert(slots.size() <= GENKEY_INDEX_MAX);
+            slots.push_back(SlotEntry{});
+            slot_index = (u32)slots.size() - 1;
+        }
+
+        SlotEntry &se = slots[slot_index];
+        se.value_index = count();
+        se.live = true;
+
+        value_slots.push_back(slot_index);
+
+        return genkey_make(slot_index, se.gen);
+    }
+
+    // false if the key was stale. otherwise the owner moves its value at out_last into out_hole
+    //  (when they differ) and pops its last value.
+    bool remove(GenKey k, u32 &out_hole, u32 &out_last) {
+
+        if (find(k) == SLOT_NONE)
+            return false;
+
+        SlotEntry &se = slots[k.index];
+
+        out_hole = se.value_index;
+        out_last = count() - 1;
+
+        if (out_hole != out_last) {
+            value_slots[out_hole] = value_slots[out_last];
+            slots[value_slots[out_last]].value_index = out_hole;
+        }
+        value_slots.pop_back();
+
+        se.gen = genkey_next_gen(se.gen);
+        se.live = false;
+        free_slots.push_back(k.index);
+
+        return true;
+    }
+
+    // every key goes stale, the owner clears its values
+    void remove_all() {
+        for (u32 slot_index : value_slots) {
+            slots[slot_index].gen = genkey_next_gen(slots[slot_index].gen);
+            slots[slot_index].live = false;
+            free_slots.push_back(slot_index);
+        }
+
+        value_slots.clear();
+    }
+
+    void clear() {
+        value_slots.clear();
+        slots.clear();
+        free_slots.clear();
+    }
+
+    void reserve(u32 n) {
+        value_slots.reserve(n);
+        slots.reserve(n);
+        free_slots.reserve(n);
+    }
+};
+
+// Same keys as GenVec, but the live values are packed at the front of `values`, so iterating them is a plain loop
+//  with no dead slots to skip. Keys go through `table` to find their value. remove swaps the last value into the
+//  hole, so the order of values changes and pointers to the last value go stale.
+template <typename T>
+struct SlotMap {
+    vec<T> values;
+    SlotTable table;
+
+    // 0 if the key is stale or out of range
+    T *get(GenKey k) {
+        u32 i = table.find(k);
+        return i == SLOT_NONE ? 0 : &values[i];
+    }
+
+    // out[i] = get(keys[i]) for a whole array of keys. the slots a few keys ahead are prefetched, and so is
+    //  every value that resolves, so the caller's first touch of it doesn't miss either.
+    void get_many(span<const GenKey> keys, span<T *> out) {
+        genvec_assert(out.size() >= keys.size());
+
+        for (u64 i = 0; i < keys.size(); ++i) {
+            if (i + GENVEC_PREFETCH_DISTANCE < keys.size()) {
+                u32 ahead = keys[i + GENVEC_PREFETCH_DISTANCE].index;
+                if (ahead < table.slots.size()) {
+                    genvec_prefetch(&table.slots[ahead]);
+                }
+            }
+
+            out[i] = get(keys[i]);
+            if (out[i]) {
+                genvec_prefetch(out[i]);
+            }
+        }
+    }
+
+    // key of the value at values[value_index], for removing while iterating
+    GenKey key_of(u64 value_index) {
+        return table.key_of((u32)value_index);
+    }
+
+    void remove(GenKey k) {
+        u32 hole, last;
+        if (!table.remove(k, hole, last))
+            return;
+
+        // moving the last value into the hole
+        if (hole != last) {
+            values[hole] = values[last];
+        }
+        values.pop_back();
+    }
+
+    GenKey add(T entry) {
+        GenKey key = table.add();
+        values.push_back(entry);
+        return key;
+    }
+
+    // safe way to "clear"
+    void remove_all() {
+        table.remove_all();
+        values.clear();
+    }
+
+    void clear() {
+        table.clear();
+        values.clear();
+    }
+};
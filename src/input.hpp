@@ -98,6 +98,7 @@ enum struct Action : u32 {
     Back,
     CameraLeft,
     CameraRight,
+    WalkTo,
 };
 
 struct ActionMap {
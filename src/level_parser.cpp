@@ -43,9 +43,9 @@ ParseResult advance_until_plane_end(Parser p) {
     return res;
 }
 
-// sets level width, height, and it fills the level plane with the right entities
+// sets level width, height, and it fills the level with the right entities
 // sets res.i_next to 1 char after the newline at the end of the plane
-ParseResult parse_plane(Parser p, u32 &last_id, i32 &plane_w, i32 &plane_h, LevelPlane &lp) {
+ParseResult parse_plane(Parser p, u32 &last_id, Level &level) {
 
     i32 c_width = 0;
     i32 max_width = 0;
@@ -82,74 +82,84 @@ ParseResult parse_plane(Parser p, u32 &last_id, i32 &plane_w, i32 &plane_h, Leve
     const u32 CELL_PADDING = 3;
 
     // adding empty padding
-    plane_w = max_width + (CELL_PADDING * 2);
-    plane_h = height + (CELL_PADDING * 2);
+    u32 plane_w = max_width + (CELL_PADDING * 2);
+    u32 plane_h = height + (CELL_PADDING * 2);
+
+    if (plane_w > PLANE_MAX_WIDTH || plane_h > PLANE_MAX_HEIGHT) {
+        res.succeeded = false;
+        return res;
+    }
 
     // populating the level cells
     {
         c_width = 0;
 
         // clearing plane
-        lp = {};
+        level_init(level, plane_w, plane_h);
 
-        const auto place_te = [](LevelCell &cell, u32 id, Tile tile) {
+        u32 y = 0;
+
+        // only cells that get something have their chunk allocated
+        const auto place_te = [&level, &c_width, &y](u32 id, Tile tile) {
+            Coord c = {c_width + (i32)CELL_PADDING, (i32)(y + CELL_PADDING)};
             TileEntity te = {};
             te.id = id;
             te.tile = tile;
-            cell_place(cell, te);
-        };
+            cell_place(level_cell_mut(level, c), te);
 
-        u32 y = 0;
+            if (tile == Tile::Player) {
+                level.player_hint = c;
+            }
+        };
 
         for (u32 i = p.index; i < level_end; ++i) {
-            auto &cell = lp[c_width + CELL_PADDING][y + CELL_PADDING];
 
             switch ((*p.b)[i]) {
             case (char)Tile::Empty:
                 ++c_width;
                 break;
             case (char)Tile::Floor:
-                place_te(cell, last_id++, Tile::Floor);
+                place_te(last_id++, Tile::Floor);
                 ++c_width;
                 break;
             case (char)Tile::Wall:
-                place_te(cell, last_id++, Tile::Wall);
-                place_te(cell, last_id++, Tile::Floor);
+                place_te(last_id++, Tile::Wall);
+                place_te(last_id++, Tile::Floor);
                 ++c_width;
                 break;
             case (char)Tile::Player:
-                place_te(cell, last_id++, Tile::Player);
-                place_te(cell, last_id++, Tile::Floor);
+                place_te(last_id++, Tile::Player);
+                place_te(last_id++, Tile::Floor);
                 ++c_width;
                 break;
             case (char)Tile::Box:
-                place_te(cell, last_id++, Tile::Box);
-                place_te(cell, last_id++, Tile::Floor);
+                place_te(last_id++, Tile::Box);
+                place_te(last_id++, Tile::Floor);
                 ++c_width;
                 break;
             case (char)Tile::Goal:
-                place_te(cell, last_id++, Tile::Goal);
-                place_te(cell, last_id++, Tile::Floor);
+                place_te(last_id++, Tile::Goal);
+                place_te(last_id++, Tile::Floor);
                 ++c_width;
                 break;
             case (char)Tile::MirrorUL:
-                place_te(cell, last_id++, Tile::MirrorUL);
-                place_te(cell, last_id++, Tile::Floor);
+                place_te(last_id++, Tile::MirrorUL);
+                place_te(last_id++, Tile::Floor);
                 ++c_width;
                 break;
             case (char)Tile::MirrorUR:
-                place_te(cell, last_id++, Tile::MirrorUR);
-                place_te(cell, last_id++, Tile::Floor);
+                place_te(last_id++, Tile::MirrorUR);
+                place_te(last_id++, Tile::Floor);
                 ++c_width;
                 break;
             case (char)Tile::MirrorDL:
-                place_te(cell, last_id++, Tile::MirrorDL);
-                place_te(cell, last_id++, Tile::Floor);
+                place_te(last_id++, Tile::MirrorDL);
+                place_te(last_id++, Tile::Floor);
                 ++c_width;
                 break;
             case (char)Tile::MirrorDR:
-                place_te(cell, last_id++, Tile::MirrorDR);
-                place_te(cell, last_id++, Tile::Floor);
+                place_te(last_id++, Tile::MirrorDR);
+                place_te(last_id++, Tile::Floor);
                 ++c_width;
                 break;
             case '\n':
@@ -304,10 +314,12 @@ bool load_levels_from_file(string_view filename, vec<LevelNamed> &levels) {
         } break;
         case ParseWhat::LevelPlane: {
 
-            i32 p_w, p_h;
-            LevelPlane lp;
+            // there's only room for one plane
+            if (plane_i >= PLANE_MAX_COUNT) {
+                return false;
+            }
 
-            res_i = parse_plane(p, te_id_i, p_w, p_h, lp);
+            res_i = parse_plane(p, te_id_i, level_named.level);
 
             if (!res_i.succeeded) {
                 return false;
@@ -315,11 +327,7 @@ bool load_levels_from_file(string_view filename, vec<LevelNamed> &levels) {
 
             p.index = res_i.i_next;
 
-            level_named.level.width = p_w;
-            level_named.level.height = p_h;
-
-            level_named.level.data[plane_i++] = lp;
-            level_named.level.plane_count = plane_i;
+            level_named.level.plane_count = ++plane_i;
 
             res_i = parse::is_next(p, plane_separator);
 
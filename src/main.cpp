@@ -8,6 +8,80 @@
 #include "audio.hpp"
 #include "system.hpp"
 
+#include <stdio.h>
+
+namespace {
+
+// the value after `name` on the command line, empty when it's not there. values can be in quotes.
+string_view arg_value(string_view args, string_view name) {
+    while (!args.empty()) {
+        while (!args.empty() && args.front() == ' ') {
+            args.remove_prefix(1);
+        }
+
+        u64 arg_end = args.find(' ');
+        string_view arg = args.substr(0, arg_end);
+        args.remove_prefix(arg.size());
+
+        if (arg != name) {
+            continue;
+        }
+
+        while (!args.empty() && args.front() == ' ') {
+            args.remove_prefix(1);
+        }
+        if (!args.empty() && args.front() == '"') {
+            u64 quote_end = args.find('"', 1);
+            return args.substr(1, quote_end == string_view::npos ? string_view::npos : quote_end - 1);
+        }
+        return args.substr(0, args.find(' '));
+    }
+    return {};
+}
+
+// runs the simulation for step_count fixed steps as fast as it goes, without drawing anything. every time
+//  the animations and timers run out, the next level starts with its transition, so there's always
+//  something to step. the same step_count always does the same work, so the time is comparable between runs.
+void run_headless(App &app, u64 step_count, f64 seconds_per_count) {
+    app.game_state = GameState::Game;
+    app_switch_to_level(app, 0, true);
+    u32 level_starts = 1;
+
+    i64 time_start;
+    QueryPerformanceCounter((LARGE_INTEGER *)&time_start);
+
+    for (u64 i = 0; i < step_count; ++i) {
+        bool idle = app.as.anims.empty() && app.as.pending.empty() && app.ts.timers.values.empty();
+        if (idle) {
+            app_switch_to_level(app, (app.current_level + 1) % (i32)app.levels.size(), true);
+            ++level_starts;
+        }
+
+        app_sim_step(app);
+    }
+
+    i64 time_end;
+    QueryPerformanceCounter((LARGE_INTEGER *)&time_end);
+    f64 seconds = (f64)(time_end - time_start) * seconds_per_count;
+
+    string report = format("{} steps ({:.1f}s of game time, {} level starts) in {:.3f}s: {:.2f}us per step",
+                           step_count, (f64)step_count * sim_step_s, level_starts, seconds,
+                           seconds * 1e6 / (f64)math::Max(1ull, (unsigned long long)step_count));
+
+    log("%s", report.c_str());
+
+    // the game has no console of its own, printing to the one it was started from
+    if (AttachConsole(ATTACH_PARENT_PROCESS)) {
+        FILE *f;
+        if (freopen_s(&f, "CONOUT$", "w", stdout) == 0) {
+            printf("\n%s\n", report.c_str());
+            fclose(f);
+        }
+    }
+}
+
+} // namespace
+
 int WINAPI WinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE, _In_ LPSTR args, _In_ int) {
 
 #ifdef _DEBUG
@@ -23,6 +97,15 @@ int WINAPI WinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE, _In_ LPSTR args
     Input *input = new Input{};
     AudioData *ad = new AudioData{};
 
+    // playing another levels file, like the big ones the stress tool writes
+    string_view levels_file = arg_value(args, "--levels");
+    if (!levels_file.empty()) {
+        app->levels_file = string(levels_file);
+    }
+
+    // --headless-steps N only steps the simulation, see run_headless
+    u64 headless_steps = strtoull(string(arg_value(args, "--headless-steps")).c_str(), 0, 10);
+
     Ctx ctx = {};
     ctx.app = app;
     ctx.renderer = renderer;
@@ -45,6 +128,11 @@ int WINAPI WinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE, _In_ LPSTR args
     QueryPerformanceCounter((LARGE_INTEGER *)&time_last);
     renderer->seconds_per_count = seconds_per_count;
 
+    if (headless_steps > 0) {
+        run_headless(*app, headless_steps, seconds_per_count);
+        return 0;
+    }
+
     MSG msg = {};
 
     // main loop
@@ -34,6 +34,9 @@ namespace {
 const int CLIENT_WIDTH_INITIAL = 1500;
 const int CLIENT_HEIGHT_INITIAL = 800;
 
+// instances the buffer has room for at startup, it grows from there when a frame needs more
+const u32 INSTANCED_BUFFER_INITIAL_CAPACITY = 10000;
+
 const aiScene *assimp_read_file(Assimp::Importer &importer, string_view filename) {
 
     const aiScene *scene = importer.ReadFile(
@@ -67,6 +70,28 @@ void internal_draw_shapes(Renderer &renderer, Context &c, u32 current_shape_coun
     c.DrawIndexedInstanced(co.count, current_shape_count, co.offset, co.vert_offset, current_shape_offset);
 };
 
+// makes sure renderer.instanced_buffer fits count instances. it's recreated at least twice as big when it doesn't,
+//  so growing a level of shapes only reallocates a handful of times.
+void instanced_buffer_fit(Renderer &renderer, u32 count) {
+    if (renderer.instanced_buffer && count <= renderer.instanced_buffer_capacity) {
+        return;
+    }
+
+    u32 capacity = math::Max(count, renderer.instanced_buffer_capacity * 2);
+    capacity = math::Max(capacity, INSTANCED_BUFFER_INITIAL_CAPACITY);
+
+    D3D11_BUFFER_DESC vbd = {};
+    vbd.Usage = D3D11_USAGE_DYNAMIC;
+    vbd.ByteWidth = (u32)(sizeof(InstancedData) * capacity);
+    vbd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+    vbd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+
+    HRESULT hr = renderer.device->CreateBuffer(&vbd, 0, renderer.instanced_buffer.ReleaseAndGetAddressOf());
+    lassert_s(SUCCEEDED(hr), "could not create the instance buffer");
+
+    renderer.instanced_buffer_capacity = capacity;
+}
+
 // given an image file, it creates a texture2d, a srv, and generates all the mipmaps.
 void create_texture_from_image(const char *filename, Renderer &r, ComPtr<ID3D11ShaderResourceView> &srv) {
     int image_width;
@@ -1231,15 +1256,8 @@ bool init_renderer(Ctx &ctx) {
     lassert_s(render_resources_init(*r.device.Get(), r.resources), "could not initialize render resources");
 
     // initing instanced buffer
-    {
-        const size_t max_box_count = 10000;
-        D3D11_BUFFER_DESC vbd = {};
-        vbd.Usage = D3D11_USAGE_DYNAMIC;
-        vbd.ByteWidth = (u32)(sizeof(InstancedData) * max_box_count);
-        vbd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-        vbd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-        r.device->CreateBuffer(&vbd, 0, r.instanced_buffer.GetAddressOf());
-    }
+    r.instanced_buffer_capacity = 0;
+    instanced_buffer_fit(r, INSTANCED_BUFFER_INITIAL_CAPACITY);
 
     Font font_demo = {};
 
@@ -1457,10 +1475,26 @@ void rend::set_text_camera(Renderer &renderer, Camera cam) {
 }
 
 void rend::draw_shape(Renderer &renderer, Shape shape) {
-    if (1.0f - shape.color.w < F32_EPSILON) {
-        renderer.shapes_opaque.push_back(shape);
+    XMMATRIX cube_scale = XMMatrixScaling(shape.scale.x, shape.scale.y, shape.scale.z);
+    XMMATRIX cube_translation = XMMatrixTranslation(shape.pos.x, shape.pos.y, shape.pos.z);
+
+    XMMATRIX cube_rot = XMMatrixRotationQuaternion(math::quat_load(shape.rot));
+    XMMATRIX world = cube_scale * cube_rot * cube_translation;
+
+    ShapeInstance inst = {};
+    XMStoreFloat4x4(&inst.world, world);
+    inst.color = shape.color;
+    inst.pos = shape.pos;
+    inst.kind = shape.kind;
+
+    draw_shape_instance(renderer, inst);
+}
+
+void rend::draw_shape_instance(Renderer &renderer, const ShapeInstance &inst) {
+    if (1.0f - inst.color.w < F32_EPSILON) {
+        renderer.shapes_opaque.push_back(inst);
     } else {
-        renderer.shapes_transparent.push_back(shape);
+        renderer.shapes_transparent.push_back(inst);
     }
 }
 
@@ -1563,7 +1597,7 @@ void rend::construct_frame(Renderer &renderer) {
         XMStoreFloat4x4(&mShadowTransform, S);
     }
 
-    const auto draw_shapes = [&c, &renderer](const span<Shape> shapes, u32 offset) {
+    const auto draw_shapes = [&c, &renderer](const span<ShapeInstance> shapes, u32 offset) {
         u32 current_shape_count = 0;
         u32 current_shape_offset = offset;
         u32 current_shape_kind = 0;
@@ -1589,13 +1623,14 @@ void rend::construct_frame(Renderer &renderer) {
     };
 
     // sorting transparent boxes
+    const XMVECTOR camera_pos = renderer.camera.get_position_as_xmvector();
     std::sort(renderer.shapes_transparent.begin(), renderer.shapes_transparent.end(),
-              [renderer](const Shape &a, const Shape &b) {
+              [camera_pos](const ShapeInstance &a, const ShapeInstance &b) {
                   XMVECTOR a_pos = XMLoadFloat3(&a.pos);
                   XMVECTOR b_pos = XMLoadFloat3(&b.pos);
 
-                  auto len_a = XMVector3Length(renderer.camera.get_position_as_xmvector() - a_pos);
-                  auto len_b = XMVector3Length(renderer.camera.get_position_as_xmvector() - b_pos);
+                  auto len_a = XMVector3Length(camera_pos - a_pos);
+                  auto len_b = XMVector3Length(camera_pos - b_pos);
 
                   f32 len_a_f;
                   f32 len_b_f;
@@ -1605,28 +1640,21 @@ void rend::construct_frame(Renderer &renderer) {
               });
 
     // sorting by shape
-    std::sort(renderer.shapes_opaque.begin(), renderer.shapes_opaque.end(), [](const Shape &a, const Shape &b) {
-        return a.kind < b.kind;
-    });
-
-    vec<InstancedData> shapes_buffer(renderer.shapes_opaque.size() + renderer.shapes_transparent.size());
+    std::sort(renderer.shapes_opaque.begin(), renderer.shapes_opaque.end(),
+              [](const ShapeInstance &a, const ShapeInstance &b) { return a.kind < b.kind; });
 
+    // filling the instance buffer straight in the mapped memory
     {
-        u32 buffer_i = 0;
+        instanced_buffer_fit(renderer, (u32)(renderer.shapes_opaque.size() + renderer.shapes_transparent.size()));
 
-        const auto fill_buffer_at = [&shapes_buffer, &mShadowTransform](u32 i, const Shape &shape) {
-            XMMATRIX cube_scale = XMMatrixScaling(shape.scale.x, shape.scale.y, shape.scale.z);
-            XMMATRIX cube_translation = XMMatrixTranslation(shape.pos.x, shape.pos.y, shape.pos.z);
+        D3D11_MAPPED_SUBRESOURCE mapped_res = {};
+        c.Map(renderer.instanced_buffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped_res);
+        InstancedData *shapes_buffer = (InstancedData *)mapped_res.pData;
 
-            XMMATRIX world;
+        u32 buffer_i = 0;
 
-            if (!math::rot_is_valid(shape.rot)) {
-                world = cube_scale * cube_translation;
-            } else {
-                XMVECTOR rot_axis = XMLoadFloat4(&shape.rot);
-                XMMATRIX cube_rot = XMMatrixRotationAxis(rot_axis, shape.rot.w);
-                world = cube_scale * cube_rot * cube_translation;
-            }
+        const auto fill_buffer_at = [shapes_buffer, &mShadowTransform](u32 i, const ShapeInstance &shape) {
+            XMMATRIX world = XMLoadFloat4x4(&shape.world);
 
             XMMATRIX world_inv_transpose = math::InverseTranspose(world);
 
@@ -1648,15 +1676,7 @@ void rend::construct_frame(Renderer &renderer) {
             fill_buffer_at(buffer_i, shape);
             ++buffer_i;
         }
-    }
 
-    // sending instance buffer to gpu
-    {
-        D3D11_MAPPED_SUBRESOURCE mapped_res = {};
-        c.Map(renderer.instanced_buffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped_res);
-        if (shapes_buffer.size() > 0) {
-            memcpy(mapped_res.pData, &shapes_buffer[0], sizeof(InstancedData) * shapes_buffer.size());
-        }
         c.Unmap(renderer.instanced_buffer.Get(), 0);
     }
 
@@ -164,11 +164,19 @@ using ShapeCountOffsets = array<ShapeCountOffset, (size_t)ShapeKind::Count>;
 struct Shape {
     v3 pos;
     v3 scale = math::v3_one();
-    v4 rot; // axis on rot.xyz + angle on rot.w
+    v4 rot = math::quat_identity();
     v4 color = math::v4_one();
     ShapeKind kind = ShapeKind::Box;
 };
 
+// a shape with its world matrix already built, which is what the instance buffer needs
+struct ShapeInstance {
+    m4 world;
+    v4 color;
+    v3 pos; // world position, for sorting transparent shapes
+    ShapeKind kind;
+};
+
 struct TextString {
     string the_text;
     v2 text_offset; // offset from the middle of the screen i think
@@ -208,6 +216,7 @@ struct Renderer {
     ComPtr<ID3D11DepthStencilView> depth_stencil_view;
 
     ComPtr<ID3D11Buffer> instanced_buffer;
+    u32 instanced_buffer_capacity; // in instances
 
     ComPtr<ID3D11Buffer> shapes_vb;
     ComPtr<ID3D11Buffer> shapes_ib;
@@ -233,8 +242,8 @@ struct Renderer {
     D3D11_VIEWPORT depth_map_viewport;
 
     // immediate mode "state" (gets cleared at the end of every frame)
-    vec<Shape> shapes_opaque;
-    vec<Shape> shapes_transparent;
+    vec<ShapeInstance> shapes_opaque;
+    vec<ShapeInstance> shapes_transparent;
     vec<TextString> text_strings;
     bool draw_grid;
 };
@@ -261,6 +270,8 @@ void set_camera(Renderer &renderer, Camera cam);
 void set_camera_target_pos(Renderer &renderer, v3 target);
 void set_text_camera(Renderer &renderer, Camera cam);
 void draw_shape(Renderer &renderer, Shape shape);
+// for shapes whose world matrix is already known (entities with cached world transforms)
+void draw_shape_instance(Renderer &renderer, const ShapeInstance &inst);
 void construct_frame(Renderer &renderer);
 
 } // namespace rend
@@ -1,29 +1,55 @@
 #include "timer.hpp"
 
-void timers_tick(TimerSystem &ts, f32 dt_sec, void *first_arg) {
-    // ticking timers
-    for (u64 i = 0; auto &ge : ts.timers.things) {
-        if (!ge.live) {
-            goto increment;
-        }
+#include <algorithm>
+
+namespace {
+
+// the heap is a max heap on this, so the soonest deadline is on top
+bool deadline_later(const TimerDeadline &a, const TimerDeadline &b) {
+    return a.deadline_s > b.deadline_s;
+}
+
+GenKey timer_push(TimerSystem &ts, const Timer &tim) {
+    GenKey key = ts.timers.add(tim);
+
+    ts.deadlines.push_back(TimerDeadline{tim.deadline_s, key});
+    std::push_heap(ts.deadlines.begin(), ts.deadlines.end(), deadline_later);
+
+    return key;
+}
+
+} // namespace
 
-        ge.entry.t += dt_sec;
+// --------------------------------- EXPORTED FUNCTIONS (START) ---------------------------------
 
-        if (ge.entry.t >= ge.entry.duration) {
-            ge.entry.the_proc(first_arg, ge.entry.data);
-            ts.timers.remove(GenKey{i, ge.gen});
+void timers_tick(TimerSystem &ts, f32 dt_sec) {
+    ts.now_s += dt_sec;
 
-            if (ts.clear_timers) {
-                break;
-            }
+    // same tolerance as animation delays, so a timer and an animation delayed by the same amount line up
+    while (!ts.clear_timers && ts.deadlines.size() > 0 && ts.deadlines[0].deadline_s - ts.now_s <= F32_EPSILON) {
+        GenKey key = ts.deadlines[0].key;
+        std::pop_heap(ts.deadlines.begin(), ts.deadlines.end(), deadline_later);
+        ts.deadlines.pop_back();
+
+        Timer *tim = ts.timers.get(key);
+        if (!tim) {
+            --ts.stale_deadlines;
+            continue;
         }
 
-    increment:
-        ++i;
+        // the callback can add timers, so it gets a copy and the timer is gone before it runs
+        TimerCallback fired = tim->callback;
+        ts.timers.remove(key);
+        ++ts.fired;
+        fired.invoke(fired.storage);
     }
 
     if (ts.clear_timers) {
-        ts.timers.clear();
+        // remove_all so keys from before the clear stay stale and timer_cancel on one can't hit a new timer
+        ts.timers.remove_all();
+        ts.deadlines.clear();
+        ts.stale_deadlines = 0;
+        ts.now_s = 0.0;
         ts.clear_timers = false;
     }
 }
@@ -32,17 +58,33 @@ void timers_defer_clear(TimerSystem &ts) {
     ts.clear_timers = true;
 }
 
-GenKey timer_add(TimerSystem &ts, f32 duration, TimerProc the_proc) {
-    Timer tim = {};
-    tim.duration = duration;
-    tim.the_proc = the_proc;
-    return ts.timers.add(tim);
+void timers_reserve(TimerSystem &ts, u32 n) {
+    ts.timers.values.reserve(n);
+    ts.timers.table.reserve(n);
+    ts.deadlines.reserve(n);
 }
 
-GenKey timer_add_data(TimerSystem &ts, f32 duration, TimerProc the_proc, TimerProcData data) {
+GenKey timer_add_callback(TimerSystem &ts, f32 duration, const TimerCallback &callback) {
     Timer tim = {};
-    tim.duration = duration;
-    tim.the_proc = the_proc;
-    tim.data = data;
-    return ts.timers.add(tim);
+    tim.deadline_s = ts.now_s + duration;
+    tim.callback = callback;
+    return timer_push(ts, tim);
+}
+
+void timer_cancel(TimerSystem &ts, GenKey key) {
+    if (!ts.timers.get(key)) {
+        return;
+    }
+
+    ts.timers.remove(key);
+    ++ts.stale_deadlines;
+    ++ts.cancelled;
+
+    // dropping the stale deadlines once they're most of the heap, so cancelling a lot of far off timers
+    //  doesn't grow it forever. amortized over the cancels that made them, it's still O(1) each.
+    if (ts.stale_deadlines > 64 && ts.stale_deadlines * 2 > ts.deadlines.size()) {
+        std::erase_if(ts.deadlines, [&ts](const TimerDeadline &d) { return ts.timers.get(d.key) == 0; });
+        std::make_heap(ts.deadlines.begin(), ts.deadlines.end(), deadline_later);
+        ts.stale_deadlines = 0;
+    }
 }
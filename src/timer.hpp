@@ -3,34 +3,66 @@
 #include "lucytypes.hpp"
 #include "gen_vec.hpp"
 
-// There's only one option now but could be more
-enum struct TimerDataWhat { GenKey };
+#include <new>
+#include <type_traits>
 
-// There's only one option now but could be more
-union TimerProcUnion {
-    GenKey entity_key;
-};
+inline constexpr u64 TIMER_CALLBACK_SIZE = 32;
 
-struct TimerProcData {
-    TimerDataWhat what;
-    TimerProcUnion data;
+// A callable and its captures, stored inline so scheduling one never allocates. Anything trivially copyable
+//  that fits works, usually a lambda capturing the app by reference and a key or two.
+struct TimerCallback {
+    alignas(8) u8 storage[TIMER_CALLBACK_SIZE];
+    void (*invoke)(void *storage);
 };
 
-using TimerProc = void (*)(void *, TimerProcData data);
+template <typename F>
+TimerCallback timer_callback_make(F f) {
+    static_assert(sizeof(F) <= TIMER_CALLBACK_SIZE, "the captures don't fit in TIMER_CALLBACK_SIZE");
+    static_assert(alignof(F) <= 8, "the captures need more alignment than TimerCallback has");
+    // timers are copied around as bytes and never destroyed
+    static_assert(std::is_trivially_copyable_v<F>, "the captures have to be trivially copyable");
+
+    TimerCallback res = {};
+    ::new ((void *)res.storage) F(f);
+    res.invoke = [](void *storage) { (*std::launder((F *)storage))(); };
+    return res;
+}
 
 struct Timer {
-    f32 t;
-    f32 duration;
-    TimerProcData data;
-    TimerProc the_proc;
+    // TimerSystem::now_s the timer fires at
+    f64 deadline_s;
+    TimerCallback callback;
 };
 
+struct TimerDeadline {
+    f64 deadline_s;
+    GenKey key;
+};
+
+// Timers live in a SlotMap, and their deadlines in a min heap next to it, so a tick only looks at the timers
+//  that fire. Cancelling just removes the timer, its deadline stays in the heap and is dropped when it comes up.
 struct TimerSystem {
-    GenVec<Timer> timers;
+    SlotMap<Timer> timers;
+    vec<TimerDeadline> deadlines;
+    // deadlines whose timer was cancelled, the heap gets compacted when they're most of it
+    u32 stale_deadlines;
+    // seconds ticked since the last clear
+    f64 now_s;
     bool clear_timers;
+
+    // running totals since the start, for the debug ui and the anims tool
+    u64 fired;
+    u64 cancelled;
 };
 
-void timers_tick(TimerSystem &ts, f32 dt_sec, void *first_arg);
+void timers_tick(TimerSystem &ts, f32 dt_sec);
 void timers_defer_clear(TimerSystem &ts);
-GenKey timer_add(TimerSystem &ts, f32 duration, TimerProc the_proc);
-GenKey timer_add_data(TimerSystem &ts, f32 duration, TimerProc the_proc, TimerProcData data);
\ No newline at end of file
+void timers_reserve(TimerSystem &ts, u32 n);
+GenKey timer_add_callback(TimerSystem &ts, f32 duration, const TimerCallback &callback);
+// calls f() once duration seconds went by
+template <typename F>
+GenKey timer_add(TimerSystem &ts, f32 duration, F f) {
+    return timer_add_callback(ts, duration, timer_callback_make(f));
+}
+// stops the timer from firing, does nothing if it already fired or the key is stale
+void timer_cancel(TimerSystem &ts, GenKey key);
@@ -0,0 +1,516 @@
+#include "tools.hpp"
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <thread>
+
+#include "gameplay.hpp"
+#include "level_parser.hpp"
+#include "utils.hpp"
+
+namespace {
+
+// -- state encoding --
+// one byte per cell inside the level bounds. walls and goals never move, so only the
+//  moveable tile (low bits) and whether the cell has a floor are stored.
+const u8 CELL_MOVEABLE_MASK = 0x7;
+const u8 CELL_FLOOR_BIT = 1 << 3;
+
+const array<Tile, 7> moveable_tiles = {Tile::Empty,    Tile::Player,   Tile::Box,     Tile::MirrorUL,
+                                       Tile::MirrorUR, Tile::MirrorDL, Tile::MirrorDR};
+
+// decoded tile entities get ids from here on so they never clash with the static ones
+const u32 DYNAMIC_ID_START = 1 << 20;
+
+// edges that don't point at a stored state
+const u32 EDGE_WON = 0xFFFFFFFF;
+const u32 EDGE_LOST = 0xFFFFFFFE;
+const u32 EDGE_UNKNOWN = 0xFFFFFFFD; // state cap was reached, child was not stored
+
+const u32 NO_STATE = 0xFFFFFFFF;
+
+// rough bytes used per stored state, on top of its key. used to turn the memory budget into a state cap.
+const u64 STATE_OVERHEAD_BYTES = 72;
+
+const array<Direction, 5> all_directions = {Direction::Left, Direction::Right, Direction::Up, Direction::Down,
+                                            Direction::JumpAction};
+
+struct StateInfo {
+    u32 parent;
+    u32 edge_begin;
+    u16 depth;
+    u8 parent_dir;
+    u8 edge_count;
+};
+
+// every state reached so far, stored in discovery order. since the search is a BFS, this is also the queue.
+struct StateSpace {
+    u32 key_len;
+    u32 max_states;
+    vec<u8> keys;
+    vec<StateInfo> infos;
+    vec<u32> edges;
+    vec<u32> table; // open addressing. holds state index + 1, 0 is empty.
+};
+
+struct LevelStats {
+    string name;
+    bool solvable;
+    bool truncated;
+    u32 optimal_moves;
+    u32 teleports_in_optimal;
+    u64 reachable_states;
+    f64 avg_branching;
+    f64 dead_end_ratio;
+    f64 seconds;
+};
+
+u8 moveable_index(Tile tile) {
+    for (u8 i = 1; i < moveable_tiles.size(); ++i) {
+        if (moveable_tiles[i] == tile) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+void level_encode(const Level &level, u8 *out) {
+    for (u32 x = 0; x < level.width; ++x) {
+        for (u32 y = 0; y < level.height; ++y) {
+            u8 b = 0;
+            for (const auto &te : level_cell(level, Coord{(i32)x, (i32)y})) {
+                if (te.tile == Tile::Floor) {
+                    b |= CELL_FLOOR_BIT;
+                } else if (is_tile_moveable(te.tile)) {
+                    b |= moveable_index(te.tile);
+                }
+            }
+            *out++ = b;
+        }
+    }
+}
+
+// `statics` is the start level with only the walls and goals left in it
+void level_decode(const Level &statics, const u8 *key, Level &out) {
+    // reuses out's chunk memory once it has seen as many chunks
+    out = statics;
+
+    for (u32 x = 0; x < statics.width; ++x) {
+        for (u32 y = 0; y < statics.height; ++y) {
+            u8 b = *key++;
+
+            if (b == 0) {
+                continue;
+            }
+
+            LevelCell &cell = level_cell_mut(out, Coord{(i32)x, (i32)y});
+            u32 cell_id = DYNAMIC_ID_START + (x * statics.height + y) * 2;
+
+            if (b & CELL_MOVEABLE_MASK) {
+                TileEntity te = {};
+                te.id = cell_id;
+                te.tile = moveable_tiles[b & CELL_MOVEABLE_MASK];
+                cell_place(cell, te);
+
+                if (te.tile == Tile::Player) {
+                    out.player_hint = Coord{(i32)x, (i32)y};
+                }
+            }
+
+            if (b & CELL_FLOOR_BIT) {
+                TileEntity te = {};
+                te.id = cell_id + 1;
+                te.tile = Tile::Floor;
+                cell_place(cell, te);
+            }
+        }
+    }
+}
+
+u64 hash_key(const u8 *key, u32 len) {
+    // FNV-1a
+    u64 h = 14695981039346656037ull;
+    for (u32 i = 0; i < len; ++i) {
+        h ^= key[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+void space_init(StateSpace &ss, u32 key_len, u32 max_states) {
+    ss.key_len = key_len;
+    ss.max_states = max_states;
+
+    u64 table_size = 1;
+    while (table_size < (u64)max_states * 2) {
+        table_size <<= 1;
+    }
+    ss.table.assign(table_size, 0);
+}
+
+// returns the index of the state with `key`, adding it if it's new.
+// returns EDGE_UNKNOWN when the state is new but the space is full.
+u32 space_find_or_add(StateSpace &ss, const u8 *key, bool &out_added) {
+    out_added = false;
+
+    u64 mask = ss.table.size() - 1;
+    u64 slot = hash_key(key, ss.key_len) & mask;
+
+    while (ss.table[slot] != 0) {
+        u32 index = ss.table[slot] - 1;
+        if (memcmp(&ss.keys[(u64)index * ss.key_len], key, ss.key_len) == 0) {
+            return index;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    if (ss.infos.size() >= ss.max_states) {
+        return EDGE_UNKNOWN;
+    }
+
+    u32 index = (u32)ss.infos.size();
+    ss.keys.insert(ss.keys.end(), key, key + ss.key_len);
+    ss.infos.push_back(StateInfo{});
+    ss.table[slot] = index + 1;
+
+    out_added = true;
+    return index;
+}
+
+// states from which a win can still be reached, found by walking the edges backwards from the winning moves
+vec<u8> find_alive_states(const StateSpace &ss) {
+    u64 n = ss.infos.size();
+
+    // reverse edges, CSR style
+    vec<u32> rev_begin(n + 1, 0);
+    for (u32 e : ss.edges) {
+        if (e < n) {
+            ++rev_begin[e + 1];
+        }
+    }
+    for (u64 i = 0; i < n; ++i) {
+        rev_begin[i + 1] += rev_begin[i];
+    }
+
+    vec<u32> rev_fill(rev_begin.begin(), rev_begin.end() - 1);
+    vec<u32> rev(rev_begin[n]);
+
+    for (u32 s = 0; s < n; ++s) {
+        const StateInfo &info = ss.infos[s];
+        for (u32 i = 0; i < info.edge_count; ++i) {
+            u32 e = ss.edges[info.edge_begin + i];
+            if (e < n) {
+                rev[rev_fill[e]++] = s;
+            }
+        }
+    }
+
+    vec<u8> alive(n, 0);
+    vec<u32> queue = {};
+    queue.reserve(n);
+
+    for (u32 s = 0; s < n; ++s) {
+        const StateInfo &info = ss.infos[s];
+        for (u32 i = 0; i < info.edge_count; ++i) {
+            if (ss.edges[info.edge_begin + i] == EDGE_WON) {
+                alive[s] = 1;
+                queue.push_back(s);
+                break;
+            }
+        }
+    }
+
+    for (u64 q = 0; q < queue.size(); ++q) {
+        u32 s = queue[q];
+        for (u32 i = rev_begin[s]; i < rev_begin[s + 1]; ++i) {
+            u32 parent = rev[i];
+            if (!alive[parent]) {
+                alive[parent] = 1;
+                queue.push_back(parent);
+            }
+        }
+    }
+
+    return alive;
+}
+
+void analyze_level(const LevelNamed &ln, u32 max_states, LevelStats &out) {
+    auto time_start = std::chrono::steady_clock::now();
+
+    const Level &level_start = ln.level;
+
+    // levels are big, keep them off the stack
+    auto statics = std::make_unique<Level>(level_start);
+    auto lvl = std::make_unique<Level>(level_start);
+
+    level_for_each_cell(*statics, [](Coord, LevelCell &cell) {
+        for (auto &te : cell) {
+            if (te.tile == Tile::Floor || is_tile_moveable(te.tile)) {
+                te = TileEntity{};
+            }
+        }
+    });
+
+    StateSpace ss = {};
+    space_init(ss, level_start.width * level_start.height, max_states);
+
+    vec<u8> key(ss.key_len);
+    vec<u8> key_current(ss.key_len);
+
+    bool added;
+    level_encode(level_start, key.data());
+    space_find_or_add(ss, key.data(), added);
+    ss.infos[0].parent = NO_STATE;
+
+    vec<Direction> moves = {};
+    vec<GameEvent> eks = {};
+    eks.reserve(64);
+
+    u32 won_from = NO_STATE;
+    Direction won_dir = Direction::Left;
+    u64 valid_moves = 0;
+
+    out = {};
+    out.name = ln.name;
+
+    for (u32 s = 0; s < ss.infos.size(); ++s) {
+        memcpy(key_current.data(), &ss.keys[(u64)s * ss.key_len], ss.key_len);
+        u16 depth = ss.infos[s].depth;
+        u32 edge_begin = (u32)ss.edges.size();
+
+        bool needs_decode = true;
+
+        for (auto dir : all_directions) {
+            // invalid moves leave the level untouched, so it only has to be rebuilt after a valid one
+            if (needs_decode) {
+                level_decode(*statics, key_current.data(), *lvl);
+                needs_decode = false;
+            }
+
+            eks.clear();
+            moves.clear();
+            game_tick(dir, *lvl, level_start, moves, eks);
+
+            if (eks.size() == 0) {
+                continue;
+            }
+
+            needs_decode = true;
+            ++valid_moves;
+
+            u32 edge;
+
+            if (is_game_won(eks)) {
+                edge = EDGE_WON;
+                if (won_from == NO_STATE) {
+                    won_from = s;
+                    won_dir = dir;
+                }
+            } else if (is_game_over(eks)) {
+                edge = EDGE_LOST;
+            } else {
+                level_encode(*lvl, key.data());
+                edge = space_find_or_add(ss, key.data(), added);
+
+                if (edge == EDGE_UNKNOWN) {
+                    out.truncated = true;
+                } else if (added) {
+                    StateInfo &child = ss.infos[edge];
+                    child.parent = s;
+                    child.parent_dir = (u8)dir;
+                    child.depth = depth + 1;
+                }
+            }
+
+            ss.edges.push_back(edge);
+        }
+
+        ss.infos[s].edge_begin = edge_begin;
+        ss.infos[s].edge_count = (u8)(ss.edges.size() - edge_begin);
+    }
+
+    u64 n = ss.infos.size();
+
+    out.reachable_states = n;
+    out.avg_branching = (f64)valid_moves / (f64)n;
+    out.solvable = won_from != NO_STATE;
+
+    if (out.solvable) {
+        out.optimal_moves = ss.infos[won_from].depth + 1u;
+        out.teleports_in_optimal = won_dir == Direction::JumpAction ? 1 : 0;
+
+        for (u32 s = won_from; ss.infos[s].parent != NO_STATE; s = ss.infos[s].parent) {
+            if ((Direction)ss.infos[s].parent_dir == Direction::JumpAction) {
+                ++out.teleports_in_optimal;
+            }
+        }
+    }
+
+    vec<u8> alive = find_alive_states(ss);
+    u64 dead = 0;
+    for (u8 a : alive) {
+        if (!a) {
+            ++dead;
+        }
+    }
+    out.dead_end_ratio = (f64)dead / (f64)n;
+
+    out.seconds = std::chrono::duration<f64>(std::chrono::steady_clock::now() - time_start).count();
+}
+
+string json_escape(string_view s) {
+    string res = {};
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            res += '\\';
+        }
+        res += c;
+    }
+    return res;
+}
+
+bool write_csv(string_view filename, span<LevelStats> stats) {
+    std::ofstream f((string(filename)));
+    if (!f.is_open()) {
+        return false;
+    }
+
+    f << "index,name,solvable,optimal_moves,reachable_states,avg_branching,teleports_in_optimal,dead_end_ratio,"
+         "truncated,seconds\n";
+
+    for (u32 i = 0; const auto &st : stats) {
+        string name = st.name;
+        std::replace(name.begin(), name.end(), '"', '\'');
+
+        f << format("{},\"{}\",{},{},{},{:.4f},{},{:.4f},{},{:.3f}\n", i, name, st.solvable ? 1 : 0,
+                    st.solvable ? (i64)st.optimal_moves : -1, st.reachable_states, st.avg_branching,
+                    st.teleports_in_optimal, st.dead_end_ratio, st.truncated ? 1 : 0, st.seconds);
+        ++i;
+    }
+
+    return true;
+}
+
+bool write_json(string_view filename, span<LevelStats> stats) {
+    std::ofstream f((string(filename)));
+    if (!f.is_open()) {
+        return false;
+    }
+
+    f << "[\n";
+
+    for (u32 i = 0; const auto &st : stats) {
+        f << format("  {{\"index\": {}, \"name\": \"{}\", \"solvable\": {}, \"optimal_moves\": {}, "
+                    "\"reachable_states\": {}, \"avg_branching\": {:.4f}, \"teleports_in_optimal\": {}, "
+                    "\"dead_end_ratio\": {:.4f}, \"truncated\": {}, \"seconds\": {:.3f}}}{}\n",
+                    i, json_escape(st.name), st.solvable ? "true" : "false",
+                    st.solvable ? (i64)st.optimal_moves : -1, st.reachable_states, st.avg_branching,
+                    st.teleports_in_optimal, st.dead_end_ratio, st.truncated ? "true" : "false", st.seconds,
+                    i + 1 < stats.size() ? "," : "");
+        ++i;
+    }
+
+    f << "]\n";
+
+    return true;
+}
+
+} // namespace
+
+// --------------------------------- EXPORTED FUNCTIONS (START) ---------------------------------
+
+// Explores the full state space of every level with a BFS that plays moves through game_tick,
+//  so the numbers always follow the current rules. Levels are spread over worker threads, and the
+//  per-level state cap is derived from the memory budget so the whole run stays bounded.
+i32 tool_analyze(span<string_view> args) {
+    string levels_file = string(args_get(args, "--levels", "assets/levels/1.lvl"));
+    string out_prefix = string(args_get(args, "--out", "level_stats"));
+
+    u32 thread_count = (u32)args_get_u64(args, "--threads", math::Max(1u, std::thread::hardware_concurrency()));
+    u64 max_states = args_get_u64(args, "--max-states", 1'000'000);
+    u64 max_memory_mb = args_get_u64(args, "--max-memory-mb", 2048);
+
+    vec<LevelNamed> levels = {};
+    if (!load_levels_from_file(levels_file, levels)) {
+        printf("could not load levels from %s\n", levels_file.c_str());
+        return 1;
+    }
+
+    thread_count = math::Max(1u, math::Min(thread_count, (u32)levels.size()));
+
+    vec<LevelStats> stats(levels.size());
+    std::atomic<u32> next_level = 0;
+
+    const auto worker = [&]() {
+        while (true) {
+            u32 i = next_level.fetch_add(1);
+            if (i >= levels.size()) {
+                break;
+            }
+
+            const Level &l = levels[i].level;
+            u64 bytes_per_state = l.width * l.height + STATE_OVERHEAD_BYTES;
+            u64 budget_states = (max_memory_mb * 1024 * 1024) / thread_count / bytes_per_state;
+            u32 level_max_states = (u32)math::Min(math::Min(max_states, budget_states), (u64)EDGE_UNKNOWN - 1);
+
+            analyze_level(levels[i], level_max_states, stats[i]);
+
+            printf("[%2u] %-24s %s\n", i, levels[i].name.c_str(), stats[i].truncated ? "(truncated)" : "done");
+        }
+    };
+
+    vec<std::thread> threads = {};
+    for (u32 t = 0; t < thread_count; ++t) {
+        threads.emplace_back(worker);
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    printf("\n%-4s %-24s %8s %10s %9s %9s %9s\n", "#", "name", "optimal", "states", "branching", "teleports",
+           "dead-end");
+
+    for (u32 i = 0; const auto &st : stats) {
+        printf("%-4u %-24s %8s %10llu %9.2f %9u %8.1f%%\n", i, st.name.c_str(),
+               st.solvable ? format("{}", st.optimal_moves).c_str() : "-", (unsigned long long)st.reachable_states,
+               st.avg_branching, st.teleports_in_optimal, st.dead_end_ratio * 100.0);
+        ++i;
+    }
+
+    // suggested order: shortest solutions first, ties broken by how easy it is to get stuck
+    vec<u32> order(stats.size());
+    for (u32 i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](u32 a, u32 b) {
+        const LevelStats &sa = stats[a];
+        const LevelStats &sb = stats[b];
+        if (sa.solvable != sb.solvable)
+            return sa.solvable;
+        if (sa.optimal_moves != sb.optimal_moves)
+            return sa.optimal_moves < sb.optimal_moves;
+        return sa.dead_end_ratio < sb.dead_end_ratio;
+    });
+
+    printf("\nsuggested order by measured difficulty:\n");
+    for (u32 i : order) {
+        printf("  %s\n", stats[i].name.c_str());
+    }
+
+    string csv_name = out_prefix + ".csv";
+    string json_name = out_prefix + ".json";
+
+    if (!write_csv(csv_name, stats) || !write_json(json_name, stats)) {
+        printf("could not write %s / %s\n", csv_name.c_str(), json_name.c_str());
+        return 1;
+    }
+
+    printf("\nwrote %s and %s\n", csv_name.c_str(), json_name.c_str());
+
+    return 0;
+}
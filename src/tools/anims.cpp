@@ -0,0 +1,210 @@
+#include "tools.hpp"
+
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+
+#include "animation.hpp"
+#include "timer.hpp"
+#include "utils.hpp"
+
+namespace {
+
+// the game's sim_step_s, a frame here is one simulation step of the game
+const f32 STEP_S = 1.0f / 240.0f;
+// float channels the float animations go to, like the camera angle in the game
+const u32 FLOAT_CHANNEL_COUNT = 16;
+
+f64 seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<f64>(std::chrono::steady_clock::now() - start).count();
+}
+
+v4 random_v4(math::Rng &rng) {
+    return v4(math::rng_f(rng), math::rng_f(rng), math::rng_f(rng), math::rng_f(rng));
+}
+
+// a rotation around y, so slerping between two of them stays a rotation
+v4 random_quat(math::Rng &rng) {
+    f32 angle = math::rng_f(rng) * math::Tau;
+    return v4(0.0f, sinf(angle * 0.5f), 0.0f, cosf(angle * 0.5f));
+}
+
+// any kind of animation the game can queue: every prop, ease function and conflict resolution, some delayed,
+//  some keyframed and a few on floats
+Animated random_anim(AnimationSystem &as, math::Rng &rng, span<const GenKey> entities,
+                     span<const GenKey> channels) {
+    Animated a = {};
+    a.ease_function = (EaseFunction)math::rng_i(rng, 0, (i32)EaseFunction::Count);
+    a.conflict_resolution = (AnimationConflictResolution)math::rng_i(rng, 0, 3);
+    a.duration_s = 0.05f + math::rng_f(rng) * 0.95f;
+    a.delay_s = math::rng_i(rng, 0, 100) < 30 ? math::rng_f(rng) : 0.0f;
+
+    if (math::rng_i(rng, 0, 64) == 0) {
+        a.the_thing = AnimatedThing::Float;
+        a.simple.channel = channels[math::rng_i(rng, 0, (i32)channels.size())];
+        a.simple.prev = math::rng_f(rng);
+        a.simple.target = math::rng_f(rng);
+        return a;
+    }
+
+    a.the_thing = AnimatedThing::Entity;
+    a.ent.entity_id = entities[math::rng_i(rng, 0, (i32)entities.size())];
+    a.ent.what = (EntityProp)math::rng_i(rng, 0, (i32)EntityProp::Count);
+
+    bool is_rot = a.ent.what == EntityProp::Rotation;
+    a.ent.prev = is_rot ? random_quat(rng) : random_v4(rng);
+
+    if (math::rng_i(rng, 0, 8) == 0) {
+        u32 key_count = (u32)math::rng_i(rng, 2, (i32)ANIM_MAX_KEYS + 1);
+        for (u32 k = 0; k < key_count; ++k) {
+            EaseFunction ef = (EaseFunction)math::rng_i(rng, 0, (i32)EaseFunction::Count);
+            anim_add_key(as, a, is_rot ? random_quat(rng) : random_v4(rng), a.duration_s / (f32)key_count, ef);
+        }
+    } else {
+        a.ent.target = is_rot ? random_quat(rng) : random_v4(rng);
+    }
+
+    return a;
+}
+
+void print_times(const char *name, vec<f64> &us) {
+    if (us.empty()) {
+        return;
+    }
+
+    f64 total = 0.0;
+    for (f64 t : us) {
+        total += t;
+    }
+
+    std::sort(us.begin(), us.end());
+    f64 p50 = us[us.size() / 2];
+    f64 p99 = us[math::Min(us.size() - 1, us.size() * 99 / 100)];
+
+    printf("%-12s avg %9.1fus  p50 %9.1fus  p99 %9.1fus  max %9.1fus\n", name, total / (f64)us.size(), p50, p99,
+           us.back());
+}
+
+} // namespace
+
+// --------------------------------- EXPORTED FUNCTIONS (START) ---------------------------------
+
+// Keeps --count animations and --timers timers queued, topping them up every frame as they finish, and times
+//  anims_tick and timers_tick per frame. Same seed, same work, so runs before and after a change to the
+//  animation or timer code compare directly.
+i32 tool_anims(span<string_view> args) {
+    u32 anim_count = math::Max(1u, (u32)args_get_u64(args, "--count", 100'000));
+    u32 timer_count = (u32)args_get_u64(args, "--timers", anim_count / 10);
+    u32 frame_count = math::Max(1u, (u32)args_get_u64(args, "--frames", 600));
+    u64 seed = args_get_u64(args, "--seed", 1);
+
+    math::Rng rng = math::rng_new(seed);
+
+    // about 4 animations per entity, one per prop
+    u32 entity_count = math::Max(1u, math::Min(anim_count / 4, (u32)GENKEY_INDEX_MAX));
+
+    EntitySystem es = {};
+    es.reserve(entity_count);
+    vec<GenKey> entities = {};
+    entities.reserve(entity_count);
+
+    for (u32 i = 0; i < entity_count; ++i) {
+        Entity e = {};
+        e.box.scale = math::v3_one();
+        e.box.rot = v4(0.0f, 0.0f, 0.0f, 1.0f);
+        e.box.color = math::v4_one();
+        entities.push_back(es.add(e));
+    }
+
+    AnimationSystem as = {};
+    anims_reserve(as, anim_count, entity_count);
+
+    array<f32, FLOAT_CHANNEL_COUNT> floats = {};
+    vec<GenKey> channels = {};
+    for (f32 &f : floats) {
+        channels.push_back(anims_float_add(as, &f));
+    }
+
+    TimerSystem ts = {};
+    timers_reserve(ts, timer_count);
+    vec<GenKey> timer_keys(timer_count, GenKey{});
+
+    const auto add_timer = [&](u32 i) {
+        f32 duration = math::rng_f(rng) * 2.0f;
+        timer_keys[i] = timer_add(ts, duration, [] {});
+    };
+
+    // filling everything up front
+    {
+        auto time_start = std::chrono::steady_clock::now();
+
+        while (as.anims.size() + as.pending.size() < anim_count) {
+            anims_add(as, es, random_anim(as, rng, entities, channels));
+        }
+
+        f64 seconds = seconds_since(time_start);
+        printf("%u entities, %u animations (%u delayed), %u timers\n", entity_count, (u32)as.anims.size(),
+               (u32)as.pending.size(), timer_count);
+        printf("initial fill: %.3fs, %.3fus per anims_add (%llu tries, some resolved each other)\n", seconds,
+               seconds * 1e6 / (f64)as.stats.added, (unsigned long long)as.stats.added);
+
+        for (u32 i = 0; i < timer_count; ++i) {
+            add_timer(i);
+        }
+    }
+
+    vec<f64> anims_tick_us = {};
+    vec<f64> timers_tick_us = {};
+    vec<f64> top_up_us = {};
+    anims_tick_us.reserve(frame_count);
+    timers_tick_us.reserve(frame_count);
+    top_up_us.reserve(frame_count);
+
+    u64 added_before = as.stats.added;
+
+    for (u32 frame = 0; frame < frame_count; ++frame) {
+        // topping up what finished last frame, like effects keep getting queued in a busy level. a few timers
+        //  get cancelled and replaced too.
+        auto time_start = std::chrono::steady_clock::now();
+
+        while (as.anims.size() + as.pending.size() < anim_count) {
+            anims_add(as, es, random_anim(as, rng, entities, channels));
+        }
+
+        for (u32 c = 0; c < timer_count / 100; ++c) {
+            u32 i = (u32)math::rng_i(rng, 0, (i32)timer_count);
+            timer_cancel(ts, timer_keys[i]);
+            add_timer(i);
+        }
+        for (u32 i = 0; i < timer_count; ++i) {
+            if (!ts.timers.get(timer_keys[i])) {
+                add_timer(i);
+            }
+        }
+
+        top_up_us.push_back(seconds_since(time_start) * 1e6);
+
+        time_start = std::chrono::steady_clock::now();
+        anims_tick(as, es, STEP_S);
+        anims_tick_us.push_back(seconds_since(time_start) * 1e6);
+
+        time_start = std::chrono::steady_clock::now();
+        timers_tick(ts, STEP_S);
+        timers_tick_us.push_back(seconds_since(time_start) * 1e6);
+    }
+
+    printf("\n%u frames of %.2fms:\n", frame_count, STEP_S * 1000.0f);
+    print_times("anims_tick", anims_tick_us);
+    print_times("timers_tick", timers_tick_us);
+    print_times("top up", top_up_us);
+
+    const AnimStats &st = as.stats;
+    printf("\nanims: %llu added while ticking, %llu started after a delay, %llu conflicts resolved, %llu erased\n",
+           (unsigned long long)(st.added - added_before), (unsigned long long)st.started,
+           (unsigned long long)st.conflicts_resolved, (unsigned long long)st.removed);
+    printf("anims: %u active, %u delayed, %u written in the last tick\n", (u32)as.anims.size(),
+           (u32)as.pending.size(), st.written_last_tick);
+    printf("timers: %llu fired, %llu cancelled\n", (unsigned long long)ts.fired, (unsigned long long)ts.cancelled);
+
+    return 0;
+}
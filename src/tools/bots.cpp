@@ -0,0 +1,433 @@
+#include "tools.hpp"
+
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <thread>
+
+#include "gameplay.hpp"
+#include "level_parser.hpp"
+#include "utils.hpp"
+
+namespace {
+
+enum struct BotPolicy { Random, Heuristic };
+
+const array<Direction, 5> all_directions = {Direction::Left, Direction::Right, Direction::Up, Direction::Down,
+                                            Direction::JumpAction};
+
+// "solved within N moves" is reported at these N (the ones under --max-moves, plus --max-moves itself)
+const array<u32, 5> solve_checkpoints = {10, 25, 50, 100, 200};
+
+// weight of a direction that gets the player closer to the goal, for the heuristic bot. the rest weigh 1.
+const f32 toward_goal_weight = 3.0f;
+
+struct BotConfig {
+    BotPolicy policy;
+    u32 rollouts;
+    u32 max_moves;
+    // chance that the heuristic bot notices a fatal move and takes it back, like a player reading the preview
+    f32 caution;
+    u64 seed;
+};
+
+struct BotStats {
+    u64 rollouts;
+    u64 solved;
+    u64 fell;
+    u64 stuck; // ran out of moves (or of non-fatal moves)
+    u64 ticks;
+    vec<u64> solved_at;    // [moves] -> rollouts solved with exactly that many moves
+    vec<u32> fatal_counts; // [(x * height + y) * 5 + dir] -> falls caused by that move
+};
+
+struct FatalMove {
+    Coord at;
+    Direction dir;
+    u32 count;
+};
+
+void stats_init(BotStats &st, const Level &level, u32 max_moves) {
+    st = {};
+    st.solved_at.assign(max_moves + 1, 0);
+    st.fatal_counts.assign(level.width * level.height * all_directions.size(), 0);
+}
+
+void stats_merge(BotStats &into, const BotStats &from) {
+    into.rollouts += from.rollouts;
+    into.solved += from.solved;
+    into.fell += from.fell;
+    into.stuck += from.stuck;
+    into.ticks += from.ticks;
+
+    for (u64 i = 0; i < into.solved_at.size(); ++i) {
+        into.solved_at[i] += from.solved_at[i];
+    }
+    for (u64 i = 0; i < into.fatal_counts.size(); ++i) {
+        into.fatal_counts[i] += from.fatal_counts[i];
+    }
+}
+
+Coord find_goal(const Level &level) {
+    Coord res = {};
+    bool found = false;
+
+    level_for_each_cell(level, [&](Coord c, const LevelCell &cell) {
+        for (const auto &te : cell) {
+            if (te.tile == Tile::Goal && !found) {
+                res = c;
+                found = true;
+            }
+        }
+    });
+
+    return res;
+}
+
+bool is_toward(Coord from, Coord goal, Direction dir) {
+    switch (dir) {
+    case Direction::Left:
+        return goal.x < from.x;
+    case Direction::Right:
+        return goal.x > from.x;
+    case Direction::Up:
+        return goal.y > from.y;
+    case Direction::Down:
+        return goal.y < from.y;
+    case Direction::JumpAction:
+        return false;
+    }
+    return false;
+}
+
+// the player's new coord after a tick, taken from the events instead of scanning the level
+bool player_coord_from_events(span<GameEvent> eks, Coord &out_c) {
+    bool found = false;
+    for (const auto &ev : eks) {
+        bool is_player_move = ev.kind == EventKind::NormalMove || ev.kind == EventKind::MirrorTeleport;
+        if (is_player_move && ev.te.tile == Tile::Player) {
+            out_c = ev.to;
+            found = true;
+        }
+    }
+    return found;
+}
+
+Direction pick_direction(const BotConfig &cfg, math::Rng &rng, Coord player_c, Coord goal_c, u32 banned_mask) {
+    if (cfg.policy == BotPolicy::Random) {
+        return all_directions[math::rng_i(rng, 0, (i32)all_directions.size())];
+    }
+
+    array<f32, all_directions.size()> weights = {};
+    f32 total = 0.0f;
+
+    for (u32 i = 0; auto dir : all_directions) {
+        if (!(banned_mask & (1 << i))) {
+            weights[i] = is_toward(player_c, goal_c, dir) ? toward_goal_weight : 1.0f;
+            total += weights[i];
+        }
+        ++i;
+    }
+
+    f32 r = math::rng_f(rng) * total;
+
+    for (u32 i = 0; i < weights.size(); ++i) {
+        if (weights[i] == 0.0f)
+            continue;
+        if (r < weights[i])
+            return all_directions[i];
+        r -= weights[i];
+    }
+
+    // float rounding, r landed right on the end
+    for (i32 i = (i32)weights.size() - 1; i >= 0; --i) {
+        if (weights[i] != 0.0f)
+            return all_directions[i];
+    }
+
+    return Direction::JumpAction;
+}
+
+void run_rollouts(const Level &level_start, const BotConfig &cfg, u32 rollouts, u64 seed, BotStats &st) {
+    math::Rng rng = math::rng_new(seed);
+
+    auto lvl = std::make_unique<Level>(level_start);
+    vec<Direction> moves = {};
+    moves.reserve(cfg.max_moves + 1);
+    vec<GameEvent> eks = {};
+    eks.reserve(64);
+
+    const Coord goal_c = find_goal(level_start);
+    const Coord start_c = get_player_coord(level_start);
+    const u32 all_banned = (1 << all_directions.size()) - 1;
+
+    for (u32 r = 0; r < rollouts; ++r) {
+        game_do_reset(*lvl, level_start, moves);
+        Coord player_c = start_c;
+
+        ++st.rollouts;
+
+        bool done = false;
+        u32 banned_mask = 0;
+
+        // attempts includes moves into walls, so a bot stuck against one doesn't loop forever
+        for (u32 attempt = 0; !done && moves.size() < cfg.max_moves && attempt < cfg.max_moves * 4; ++attempt) {
+            if (banned_mask == all_banned) {
+                break;
+            }
+
+            Direction dir = pick_direction(cfg, rng, player_c, goal_c, banned_mask);
+
+            eks.clear();
+            game_tick(dir, *lvl, level_start, moves, eks);
+            ++st.ticks;
+
+            if (eks.size() == 0) {
+                if (cfg.policy == BotPolicy::Heuristic) {
+                    banned_mask |= 1 << (u32)dir;
+                }
+                continue;
+            }
+
+            if (is_game_won(eks)) {
+                ++st.solved;
+                ++st.solved_at[moves.size()];
+                done = true;
+                break;
+            }
+
+            if (is_game_over(eks)) {
+                if (cfg.policy == BotPolicy::Heuristic && math::rng_f(rng) < cfg.caution) {
+                    game_do_undo(*lvl, level_start, moves);
+                    banned_mask |= 1 << (u32)dir;
+                    continue;
+                }
+
+                for (const auto &ev : eks) {
+                    if (ev.kind == EventKind::PlayerFall) {
+                        u64 cell_i = (u64)ev.from.x * level_start.height + ev.from.y;
+                        ++st.fatal_counts[cell_i * all_directions.size() + (u32)dir];
+                        break;
+                    }
+                }
+
+                ++st.fell;
+                done = true;
+                break;
+            }
+
+            player_coord_from_events(eks, player_c);
+            banned_mask = 0;
+        }
+
+        if (!done) {
+            ++st.stuck;
+        }
+    }
+}
+
+vec<FatalMove> top_fatal_moves(const BotStats &st, const Level &level, u32 count) {
+    vec<FatalMove> res = {};
+
+    for (u64 i = 0; i < st.fatal_counts.size(); ++i) {
+        if (st.fatal_counts[i] == 0)
+            continue;
+
+        u64 cell_i = i / all_directions.size();
+        FatalMove fm = {};
+        fm.at = Coord{(i32)(cell_i / level.height), (i32)(cell_i % level.height)};
+        fm.dir = all_directions[i % all_directions.size()];
+        fm.count = st.fatal_counts[i];
+        res.push_back(fm);
+    }
+
+    std::sort(res.begin(), res.end(), [](const FatalMove &a, const FatalMove &b) { return a.count > b.count; });
+
+    if (res.size() > count) {
+        res.resize(count);
+    }
+
+    return res;
+}
+
+string_view direction_name(Direction dir) {
+    switch (dir) {
+    case Direction::Left:
+        return "Left";
+    case Direction::Right:
+        return "Right";
+    case Direction::Up:
+        return "Up";
+    case Direction::Down:
+        return "Down";
+    case Direction::JumpAction:
+        return "Jump";
+    }
+    return "?";
+}
+
+string_view policy_name(BotPolicy policy) {
+    return policy == BotPolicy::Random ? "random" : "heuristic";
+}
+
+// probability of solving within n moves
+f64 solve_probability(const BotStats &st, u32 n) {
+    u64 solved = 0;
+    for (u32 i = 0; i <= n && i < st.solved_at.size(); ++i) {
+        solved += st.solved_at[i];
+    }
+    return (f64)solved / (f64)st.rollouts;
+}
+
+vec<u32> get_checkpoints(u32 max_moves) {
+    vec<u32> res = {};
+    for (u32 c : solve_checkpoints) {
+        if (c < max_moves) {
+            res.push_back(c);
+        }
+    }
+    res.push_back(max_moves);
+    return res;
+}
+
+} // namespace
+
+// --------------------------------- EXPORTED FUNCTIONS (START) ---------------------------------
+
+// Plays random or heuristic rollouts on every level through game_tick/game_do_reset to estimate how
+//  findable the solutions are. The rollouts of a level are split over worker threads, each with its own Rng.
+i32 tool_bots(span<string_view> args) {
+    string levels_file = string(args_get(args, "--levels", "assets/levels/1.lvl"));
+    string out_prefix = string(args_get(args, "--out", "bot_stats"));
+    string_view policy_arg = args_get(args, "--policy", "both");
+
+    u32 thread_count = (u32)args_get_u64(args, "--threads", math::Max(1u, std::thread::hardware_concurrency()));
+    u64 only_level = args_get_u64(args, "--level", ~0ull);
+
+    BotConfig base_cfg = {};
+    base_cfg.rollouts = (u32)args_get_u64(args, "--rollouts", 200'000);
+    base_cfg.max_moves = math::Max(1u, (u32)args_get_u64(args, "--max-moves", 100));
+    base_cfg.caution = (f32)args_get_u64(args, "--caution-percent", 90) / 100.0f;
+    base_cfg.seed = args_get_u64(args, "--seed", 1);
+
+    vec<BotPolicy> policies = {};
+    if (policy_arg == "random" || policy_arg == "both") {
+        policies.push_back(BotPolicy::Random);
+    }
+    if (policy_arg == "heuristic" || policy_arg == "both") {
+        policies.push_back(BotPolicy::Heuristic);
+    }
+    if (base_cfg.rollouts == 0) {
+        printf("--rollouts has to be at least 1\n");
+        return 1;
+    }
+
+    if (policies.size() == 0) {
+        printf("unknown policy \"%.*s\", use random, heuristic or both\n", (i32)policy_arg.size(),
+               policy_arg.data());
+        return 1;
+    }
+
+    vec<LevelNamed> levels = {};
+    if (!load_levels_from_file(levels_file, levels)) {
+        printf("could not load levels from %s\n", levels_file.c_str());
+        return 1;
+    }
+
+    thread_count = math::Max(1u, math::Min(thread_count, base_cfg.rollouts));
+
+    const vec<u32> checkpoints = get_checkpoints(base_cfg.max_moves);
+
+    std::ofstream csv(out_prefix + ".csv");
+    if (!csv.is_open()) {
+        printf("could not write %s.csv\n", out_prefix.c_str());
+        return 1;
+    }
+
+    csv << "index,name,policy,rollouts,solved,fell,stuck";
+    for (u32 c : checkpoints) {
+        csv << format(",p_solve_within_{}", c);
+    }
+    csv << ",top_fatal_moves\n";
+
+    u64 total_rollouts = 0;
+    u64 total_ticks = 0;
+    auto time_start = std::chrono::steady_clock::now();
+
+    for (u32 level_i = 0; level_i < levels.size(); ++level_i) {
+        if (only_level != ~0ull && only_level != level_i) {
+            continue;
+        }
+
+        const LevelNamed &ln = levels[level_i];
+
+        for (auto policy : policies) {
+            BotConfig cfg = base_cfg;
+            cfg.policy = policy;
+
+            vec<BotStats> thread_stats(thread_count);
+            vec<std::thread> threads = {};
+
+            for (u32 t = 0; t < thread_count; ++t) {
+                u32 rollouts = cfg.rollouts / thread_count + (t < cfg.rollouts % thread_count ? 1 : 0);
+                u64 seed = cfg.seed ^ ((u64)level_i << 32) ^ ((u64)policy << 24) ^ t;
+
+                stats_init(thread_stats[t], ln.level, cfg.max_moves);
+                threads.emplace_back(run_rollouts, std::cref(ln.level), std::cref(cfg), rollouts, seed,
+                                     std::ref(thread_stats[t]));
+            }
+
+            for (auto &t : threads) {
+                t.join();
+            }
+
+            BotStats st = {};
+            stats_init(st, ln.level, cfg.max_moves);
+            for (const auto &ts : thread_stats) {
+                stats_merge(st, ts);
+            }
+
+            total_rollouts += st.rollouts;
+            total_ticks += st.ticks;
+
+            vec<FatalMove> fatal = top_fatal_moves(st, ln.level, 3);
+
+            string fatal_str = {};
+            for (const auto &fm : fatal) {
+                if (fatal_str.size() > 0) {
+                    fatal_str += "; ";
+                }
+                fatal_str += format("({} {}) {} x{}", fm.at.x, fm.at.y, direction_name(fm.dir), fm.count);
+            }
+
+            printf("[%2u] %-22s %-9s solved %6.2f%%  fell %6.2f%%", level_i, ln.name.c_str(),
+                   string(policy_name(policy)).c_str(), 100.0 * (f64)st.solved / (f64)st.rollouts,
+                   100.0 * (f64)st.fell / (f64)st.rollouts);
+            for (u32 c : checkpoints) {
+                printf("  <=%u: %.4f", c, solve_probability(st, c));
+            }
+            printf("\n       most fatal: %s\n", fatal_str.size() > 0 ? fatal_str.c_str() : "-");
+
+            string name = ln.name;
+            std::replace(name.begin(), name.end(), '"', '\'');
+
+            csv << format("{},\"{}\",{},{},{},{},{}", level_i, name, policy_name(policy), st.rollouts, st.solved,
+                          st.fell, st.stuck);
+            for (u32 c : checkpoints) {
+                csv << format(",{:.6f}", solve_probability(st, c));
+            }
+            csv << format(",\"{}\"\n", fatal_str);
+        }
+    }
+
+    f64 seconds = std::chrono::duration<f64>(std::chrono::steady_clock::now() - time_start).count();
+
+    printf("\n%llu rollouts (%llu ticks) in %.2fs on %u threads: %.0f rollouts/min\n",
+           (unsigned long long)total_rollouts, (unsigned long long)total_ticks, seconds, thread_count,
+           (f64)total_rollouts / seconds * 60.0);
+    printf("wrote %s.csv\n", out_prefix.c_str());
+
+    return 0;
+}
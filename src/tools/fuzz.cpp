@@ -0,0 +1,465 @@
+#include "tools.hpp"
+
+#include <stdio.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "gameplay.hpp"
+#include "utils.hpp"
+
+namespace {
+
+const array<Direction, 5> all_directions = {Direction::Left, Direction::Right, Direction::Up, Direction::Down,
+                                            Direction::JumpAction};
+
+// same empty border the level parser puts around a plane, so a dumped case loads back into the same level
+const u32 CELL_PADDING = 3;
+// how often a step is a walk to a random cell (game_find_path + game_tick_path) instead of a single move
+const i32 WALK_PERCENT = 20;
+
+// tiles a generated cell can start with, and how often. walls, boxes, goals and mirrors get a floor under them.
+struct TileWeight {
+    Tile tile;
+    u32 weight;
+};
+
+const array<TileWeight, 9> tile_weights = {
+    TileWeight{Tile::Empty, 14},   TileWeight{Tile::Floor, 40},    TileWeight{Tile::Wall, 10},
+    TileWeight{Tile::Box, 16},     TileWeight{Tile::Goal, 2},      TileWeight{Tile::MirrorUL, 4},
+    TileWeight{Tile::MirrorUR, 4}, TileWeight{Tile::MirrorDL, 4},  TileWeight{Tile::MirrorDR, 4},
+};
+
+struct FuzzConfig {
+    u64 seed;
+    u32 min_size;
+    u32 max_size;
+    u32 moves_per_case;
+};
+
+struct FuzzFailure {
+    u64 case_i;
+    string reason;
+    string level_dump;
+    vec<Direction> moves;
+};
+
+u64 case_seed(u64 seed, u64 case_i) {
+    return seed ^ (case_i * 0x9E3779B97F4A7C15ull);
+}
+
+void place_te(LevelCell &cell, u32 &last_id, Tile tile) {
+    TileEntity te = {};
+    te.id = last_id++;
+    te.tile = tile;
+    cell_place(cell, te);
+}
+
+Tile random_tile(math::Rng &rng) {
+    u32 total = 0;
+    for (const auto &tw : tile_weights) {
+        total += tw.weight;
+    }
+
+    u32 r = (u32)math::rng_i(rng, 0, (i32)total);
+    for (const auto &tw : tile_weights) {
+        if (r < tw.weight) {
+            return tw.tile;
+        }
+        r -= tw.weight;
+    }
+
+    return Tile::Floor;
+}
+
+// a random level shaped like the ones level_parser makes: one player, everything solid stands on a floor
+void gen_level(math::Rng &rng, const FuzzConfig &cfg, Level &level) {
+    u32 inner_w = (u32)math::rng_i(rng, (i32)cfg.min_size, (i32)cfg.max_size + 1);
+    u32 inner_h = (u32)math::rng_i(rng, (i32)cfg.min_size, (i32)cfg.max_size + 1);
+
+    level_init(level, inner_w + CELL_PADDING * 2, inner_h + CELL_PADDING * 2);
+
+    u32 player_i = (u32)math::rng_i(rng, 0, (i32)(inner_w * inner_h));
+    u32 last_id = 1;
+
+    for (u32 x = 0; x < inner_w; ++x) {
+        for (u32 y = 0; y < inner_h; ++y) {
+            Tile tile = x * inner_h + y == player_i ? Tile::Player : random_tile(rng);
+
+            if (tile == Tile::Empty) {
+                continue;
+            }
+
+            auto &cell = level_cell_mut(level, Coord{(i32)(x + CELL_PADDING), (i32)(y + CELL_PADDING)});
+            if (tile != Tile::Floor) {
+                place_te(cell, last_id, tile);
+            }
+            place_te(cell, last_id, Tile::Floor);
+        }
+    }
+}
+
+char cell_char(const LevelCell &cell) {
+    char res = (char)Tile::Empty;
+
+    for (const auto &te : cell) {
+        if (te.tile == Tile::Empty) {
+            continue;
+        }
+        if (te.tile == Tile::Floor && res != (char)Tile::Empty) {
+            continue;
+        }
+        res = (char)te.tile;
+    }
+
+    return res;
+}
+
+// the generated level in .lvl format, for reproducing a failure in the game
+string dump_level(const Level &level) {
+    string res = "---\nfuzz\n--\n";
+
+    for (u32 y = CELL_PADDING; y < level.height - CELL_PADDING; ++y) {
+        for (u32 x = CELL_PADDING; x < level.width - CELL_PADDING; ++x) {
+            res += cell_char(level_cell(level, Coord{(i32)x, (i32)y}));
+        }
+        res += '\n';
+    }
+
+    res += "---\n";
+    return res;
+}
+
+// only the cells inside the level bounds, the invariants make sure the rest stays empty
+void region_save(const Level &level, vec<LevelCell> &out_cells) {
+    out_cells.resize(level.width * level.height);
+
+    for (u32 x = 0; x < level.width; ++x) {
+        for (u32 y = 0; y < level.height; ++y) {
+            out_cells[x * level.height + y] = level_cell(level, Coord{(i32)x, (i32)y});
+        }
+    }
+}
+
+bool te_eq(const TileEntity &a, const TileEntity &b) {
+    return a.id == b.id && a.tile == b.tile && a.has_entity == b.has_entity;
+}
+
+bool region_eq(const Level &level, const vec<LevelCell> &cells) {
+    for (u32 x = 0; x < level.width; ++x) {
+        for (u32 y = 0; y < level.height; ++y) {
+            const auto &cell_a = level_cell(level, Coord{(i32)x, (i32)y});
+            const auto &cell_b = cells[x * level.height + y];
+
+            for (u32 slot = 0; slot < CELL_SLOT_COUNT; ++slot) {
+                if (!te_eq(cell_a[slot], cell_b[slot])) {
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+// the events the undo handed back are the move's own, minus Won which the tick adds on top
+bool undo_events_eq(span<GameEvent> move_events, span<GameEvent> undo_events) {
+    u64 j = 0;
+    for (const auto &ev : move_events) {
+        if (ev.kind == EventKind::Won) {
+            continue;
+        }
+        if (j >= undo_events.size()) {
+            return false;
+        }
+
+        const auto &uv = undo_events[j++];
+        if (uv.kind != ev.kind || !te_eq(uv.te, ev.te)) {
+            return false;
+        }
+        if (uv.from.x != ev.from.x || uv.from.y != ev.from.y || uv.to.x != ev.to.x || uv.to.y != ev.to.y) {
+            return false;
+        }
+    }
+
+    return j == undo_events.size();
+}
+
+// plays a walk found by game_find_path and checks it like a move: the invariants, undo(walk(s)) == s, and that
+//  the walk lands where its steps played one by one through game_tick do. a walk adds a move per step, so it
+//  takes as many undos as steps.
+const char *check_walk(Level &level, const Level &level_start, vec<Direction> &moves, span<Direction> path,
+                       vec<GameEvent> &eks, vec<LevelCell> &before, vec<LevelCell> &after, u64 &execs) {
+    region_save(level, before);
+    u64 moves_before = moves.size();
+
+    eks.clear();
+    game_tick_path(path, level, level_start, moves, eks);
+    ++execs;
+
+    if (const char *violation = level_find_invariant_violation(level)) {
+        return violation;
+    }
+    if (const char *violation = level_find_cell_invariant_violation(level, eks)) {
+        return violation;
+    }
+
+    if (eks.size() == 0) {
+        return "a walk game_find_path found did nothing";
+    }
+    if (moves.size() != moves_before + path.size()) {
+        return "walk did not add a move per step";
+    }
+
+    region_save(level, after);
+
+    for (u64 i = 0; i < path.size(); ++i) {
+        game_do_undo(level, level_start, moves);
+        ++execs;
+    }
+
+    if (moves.size() != moves_before || !region_eq(level, before)) {
+        return "undoing a walk did not restore the level from before it";
+    }
+
+    if (is_game_over(eks)) {
+        return 0;
+    }
+
+    // a walk is the same as its steps
+    vec<GameEvent> eks_step = {};
+    for (Direction dir : path) {
+        eks_step.clear();
+        game_tick(dir, level, level_start, moves, eks_step);
+        ++execs;
+
+        if (eks_step.size() == 0) {
+            return "a step of a walk was not a valid move";
+        }
+    }
+
+    if (moves.size() != moves_before + path.size() || !region_eq(level, after)) {
+        return "a walk and its steps ended up in different places";
+    }
+
+    return 0;
+}
+
+// plays one case. returns 0 when every check passed, otherwise what broke.
+// execs counts the game_tick, game_tick_path and game_do_undo calls.
+const char *run_case(const FuzzConfig &cfg, u64 case_i, Level &level_start, Level &level, vec<Direction> &moves,
+                     u64 &execs) {
+    math::Rng rng = math::rng_new(case_seed(cfg.seed, case_i));
+
+    gen_level(rng, cfg, level_start);
+
+    if (const char *violation = level_find_invariant_violation(level_start)) {
+        return violation;
+    }
+
+    game_do_reset(level, level_start, moves);
+
+    vec<GameEvent> eks = {};
+    eks.reserve(64);
+    vec<GameEvent> eks_redo = {};
+    eks_redo.reserve(64);
+    vec<GameEvent> eks_undo = {};
+    eks_undo.reserve(64);
+    vec<LevelCell> before = {};
+    vec<LevelCell> after = {};
+    vec<Direction> path = {};
+
+    for (u32 step = 0; step < cfg.moves_per_case; ++step) {
+        // sometimes walking to a random cell of the level instead, when there's a way there
+        if (math::rng_i(rng, 0, 100) < WALK_PERCENT) {
+            Coord to = {math::rng_i(rng, (i32)CELL_PADDING, (i32)(level.width - CELL_PADDING)),
+                        math::rng_i(rng, (i32)CELL_PADDING, (i32)(level.height - CELL_PADDING))};
+
+            if (game_find_path(level, to, path)) {
+                const char *violation = check_walk(level, level_start, moves, path, eks, before, after, execs);
+                if (violation) {
+                    return violation;
+                }
+                continue;
+            }
+        }
+
+        Direction dir = all_directions[math::rng_i(rng, 0, (i32)all_directions.size())];
+
+        region_save(level, before);
+        u64 moves_before = moves.size();
+
+        eks.clear();
+        game_tick(dir, level, level_start, moves, eks);
+        ++execs;
+
+        if (const char *violation = level_find_invariant_violation(level)) {
+            return violation;
+        }
+        if (const char *violation = level_find_cell_invariant_violation(level, eks)) {
+            return violation;
+        }
+
+        if (eks.size() == 0) {
+            if (moves.size() != moves_before) {
+                return "invalid move was added to the moves";
+            }
+            if (!region_eq(level, before)) {
+                return "invalid move changed the level";
+            }
+            continue;
+        }
+
+        if (moves.size() != moves_before + 1) {
+            return "valid move was not added to the moves";
+        }
+
+        // undo(tick(s)) == s
+        region_save(level, after);
+
+        game_do_undo(level, level_start, moves, eks_undo);
+        ++execs;
+
+        if (moves.size() != moves_before || !region_eq(level, before)) {
+            return "undo did not restore the level from before the move";
+        }
+        if (!undo_events_eq(eks, eks_undo)) {
+            return "undo handed back different events than the move had";
+        }
+
+        // a lost or won level can only be undone, so the bot keeps playing from before the move
+        if (is_game_over(eks)) {
+            continue;
+        }
+
+        // replaying the same move has to land in the same place with the same events
+        eks_redo.clear();
+        game_tick(dir, level, level_start, moves, eks_redo);
+        ++execs;
+
+        if (eks_redo.size() != eks.size() || !region_eq(level, after)) {
+            return "replaying a move gave a different result";
+        }
+    }
+
+    return 0;
+}
+
+string dir_name(Direction dir) {
+    switch (dir) {
+    case Direction::Left:
+        return "L";
+    case Direction::Right:
+        return "R";
+    case Direction::Up:
+        return "U";
+    case Direction::Down:
+        return "D";
+    case Direction::JumpAction:
+        return "J";
+    }
+    return "?";
+}
+
+} // namespace
+
+// --------------------------------- EXPORTED FUNCTIONS (START) ---------------------------------
+
+// Generates random small levels and move sequences and runs them through game_tick/game_do_undo, checking
+//  level_find_invariant_violation and undo(tick(s)) == s after every step. Some steps are walks to a random
+//  cell through game_find_path/game_tick_path, checked the same way. Every case is seeded from
+//  (seed, case index), so a failure is reproduced with --case no matter how many threads found it.
+i32 tool_fuzz(span<string_view> args) {
+    FuzzConfig cfg = {};
+    cfg.seed = args_get_u64(args, "--seed", 1);
+    cfg.moves_per_case = (u32)args_get_u64(args, "--moves", 32);
+    cfg.max_size = math::Min((u32)args_get_u64(args, "--max-size", 8), PLANE_MAX_WIDTH - CELL_PADDING * 2);
+    cfg.max_size = math::Min(cfg.max_size, PLANE_MAX_HEIGHT - CELL_PADDING * 2);
+    cfg.min_size = math::Min(math::Max(1u, (u32)args_get_u64(args, "--min-size", 2)), cfg.max_size);
+
+    u64 case_count = args_get_u64(args, "--cases", 100'000);
+    u64 first_case = 0;
+
+    if (args_has(args, "--case")) {
+        first_case = args_get_u64(args, "--case", 0);
+        case_count = 1;
+    }
+
+    u32 thread_count = (u32)args_get_u64(args, "--threads", math::Max(1u, std::thread::hardware_concurrency()));
+    thread_count = math::Max(1u, (u32)math::Min((u64)thread_count, case_count));
+
+    std::atomic<u64> next_case = first_case;
+    std::atomic<u64> total_execs = 0;
+    std::atomic<bool> failed = false;
+
+    std::mutex failure_mutex;
+    FuzzFailure failure = {};
+    failure.case_i = ~0ull;
+
+    auto time_start = std::chrono::steady_clock::now();
+
+    const auto worker = [&]() {
+        auto level_start = std::make_unique<Level>();
+        auto level = std::make_unique<Level>();
+        vec<Direction> moves = {};
+        moves.reserve(cfg.moves_per_case + 1);
+
+        u64 execs = 0;
+
+        while (!failed.load(std::memory_order_relaxed)) {
+            u64 case_i = next_case.fetch_add(1);
+            if (case_i >= first_case + case_count) {
+                break;
+            }
+
+            const char *violation = run_case(cfg, case_i, *level_start, *level, moves, execs);
+
+            if (violation) {
+                failed = true;
+
+                std::lock_guard lock(failure_mutex);
+
+                // keep the lowest failing case so the report doesn't depend on thread timing
+                if (case_i < failure.case_i) {
+                    failure.case_i = case_i;
+                    failure.reason = violation;
+                    failure.level_dump = dump_level(*level_start);
+                    failure.moves = moves;
+                }
+            }
+        }
+
+        total_execs += execs;
+    };
+
+    vec<std::thread> threads = {};
+    for (u32 t = 0; t < thread_count; ++t) {
+        threads.emplace_back(worker);
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    f64 seconds = std::chrono::duration<f64>(std::chrono::steady_clock::now() - time_start).count();
+    u64 cases_done = math::Min(next_case.load(), first_case + case_count) - first_case;
+
+    printf("%llu cases, %llu execs in %.2fs on %u threads: %.0f execs/s\n", (unsigned long long)cases_done,
+           (unsigned long long)total_execs.load(), seconds, thread_count, (f64)total_execs.load() / seconds);
+
+    if (!failed) {
+        printf("all invariants held\n");
+        return 0;
+    }
+
+    printf("\ncase %llu (--seed %llu --case %llu) failed: %s\n", (unsigned long long)failure.case_i,
+           (unsigned long long)cfg.seed, (unsigned long long)failure.case_i, failure.reason.c_str());
+    printf("moves until the failure:");
+    for (auto m : failure.moves) {
+        printf(" %s", dir_name(m).c_str());
+    }
+    printf("\nlevel:\n%s", failure.level_dump.c_str());
+
+    return 1;
+}
@@ -0,0 +1,198 @@
+#include "tools.hpp"
+
+#include <stdio.h>
+#include <chrono>
+#include <fstream>
+
+#include "gameplay.hpp"
+#include "level_parser.hpp"
+#include "utils.hpp"
+
+namespace {
+
+// the level parser puts this much empty border around a plane
+const u32 CELL_PADDING = 3;
+// the floor square the player starts on, so the moves have something to push around before falling off
+const u32 START_AREA_SIZE = 32;
+// the other cells come in islands this big, like the groups of tiles real levels are made of
+const u32 ISLAND_SIZE = 8;
+
+const array<Direction, 4> walk_directions = {Direction::Left, Direction::Right, Direction::Up, Direction::Down};
+
+f64 seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<f64>(std::chrono::steady_clock::now() - start).count();
+}
+
+// a size x size plane that's almost all empty: a start area in the middle and about entity_cells cells in
+//  islands scattered over the rest, in .lvl format
+string gen_sparse_level(math::Rng &rng, u32 size, u32 entity_cells) {
+    vec<string> rows(size, string(size, (char)Tile::Empty));
+
+    u32 area = math::Min(size, START_AREA_SIZE);
+    u32 area_start = (size - area) / 2;
+
+    for (u32 y = area_start; y < area_start + area; ++y) {
+        for (u32 x = area_start; x < area_start + area; ++x) {
+            rows[y][x] = math::rng_i(rng, 0, 100) < 15 ? (char)Tile::Box : (char)Tile::Floor;
+        }
+    }
+    rows[size / 2][size / 2] = (char)Tile::Player;
+
+    u32 island = math::Min(size, ISLAND_SIZE);
+
+    for (u32 placed = 0; placed < entity_cells; placed += island * island) {
+        u32 island_x = (u32)math::rng_i(rng, 0, (i32)(size - island + 1));
+        u32 island_y = (u32)math::rng_i(rng, 0, (i32)(size - island + 1));
+
+        for (u32 y = island_y; y < island_y + island; ++y) {
+            for (u32 x = island_x; x < island_x + island; ++x) {
+                if (rows[y][x] != (char)Tile::Empty) {
+                    continue;
+                }
+
+                i32 r = math::rng_i(rng, 0, 100);
+                rows[y][x] = r < 60 ? (char)Tile::Floor : r < 80 ? (char)Tile::Wall : (char)Tile::Box;
+            }
+        }
+    }
+
+    string res = format("---\nstress {}x{}\n--\n", size, size);
+    res.reserve(res.size() + (u64)size * (size + 1) + 8);
+
+    for (const auto &row : rows) {
+        res += row;
+        res += '\n';
+    }
+
+    res += "---\n";
+    return res;
+}
+
+u32 count_tile_entities(const Level &level) {
+    u32 res = 0;
+    level_for_each_cell(level, [&res](Coord, const LevelCell &cell) {
+        for (const auto &te : cell) {
+            if (te.tile != Tile::Empty) {
+                ++res;
+            }
+        }
+    });
+    return res;
+}
+
+} // namespace
+
+// --------------------------------- EXPORTED FUNCTIONS (START) ---------------------------------
+
+// Writes a big sparse level, loads it back through the level parser and times loading, random moves and
+//  undos on it. Shows how the chunked level storage holds up when the plane is far bigger than what's on it.
+i32 tool_stress(span<string_view> args) {
+    u32 max_size = math::Min(PLANE_MAX_WIDTH, PLANE_MAX_HEIGHT) - CELL_PADDING * 2;
+    u32 size = math::Max(1u, math::Min((u32)args_get_u64(args, "--size", 1000), max_size));
+    u32 entity_cells = (u32)args_get_u64(args, "--entities", 20'000);
+    u32 move_count = (u32)args_get_u64(args, "--moves", 1000);
+    u64 seed = args_get_u64(args, "--seed", 1);
+    string out_file = string(args_get(args, "--out", "stress.lvl"));
+
+    math::Rng rng = math::rng_new(seed);
+
+    // writing the level
+    {
+        auto time_start = std::chrono::steady_clock::now();
+
+        string level_str = gen_sparse_level(rng, size, entity_cells);
+
+        std::ofstream f(out_file, std::ios::binary);
+        if (!f.is_open()) {
+            printf("could not write %s\n", out_file.c_str());
+            return 1;
+        }
+        f << level_str;
+
+        printf("wrote %s (%ux%u, %.1f MB) in %.3fs\n", out_file.c_str(), size, size,
+               (f64)level_str.size() / (1024.0 * 1024.0), seconds_since(time_start));
+    }
+
+    vec<LevelNamed> levels = {};
+
+    {
+        auto time_start = std::chrono::steady_clock::now();
+
+        if (!load_levels_from_file(out_file, levels) || levels.size() != 1) {
+            printf("could not load the level back from %s\n", out_file.c_str());
+            return 1;
+        }
+
+        const Level &l = levels[0].level;
+        u64 cells_allocated = (u64)l.chunks.size() * LEVEL_CHUNK_SIZE * LEVEL_CHUNK_SIZE;
+
+        printf("loaded in %.3fs: %u tile entities, %llu of %llu chunks allocated (%.2f%% of the cells)\n",
+               seconds_since(time_start), count_tile_entities(l), (unsigned long long)l.chunks.size(),
+               (unsigned long long)l.chunk_index.size(), 100.0 * (f64)cells_allocated / ((f64)l.width * l.height));
+    }
+
+    const Level &level_start = levels[0].level;
+    Level level = {};
+    vec<Direction> moves = {};
+    moves.reserve(move_count + 1);
+    vec<GameEvent> eks = {};
+    eks.reserve(64);
+
+    game_do_reset(level, level_start, moves);
+
+    // random walk. a move that loses gets undone right away so the walk keeps going.
+    u32 valid_moves = 0;
+    u32 lost_moves = 0;
+    f64 move_seconds = 0.0;
+    f64 lost_undo_seconds = 0.0;
+
+    for (u32 i = 0; i < move_count; ++i) {
+        Direction dir = walk_directions[math::rng_i(rng, 0, (i32)walk_directions.size())];
+
+        eks.clear();
+        auto time_start = std::chrono::steady_clock::now();
+        game_tick(dir, level, level_start, moves, eks);
+        move_seconds += seconds_since(time_start);
+
+        if (eks.size() == 0) {
+            continue;
+        }
+
+        ++valid_moves;
+
+        if (is_game_over(eks)) {
+            ++lost_moves;
+            time_start = std::chrono::steady_clock::now();
+            game_do_undo(level, level_start, moves);
+            lost_undo_seconds += seconds_since(time_start);
+        }
+    }
+
+    printf("%u moves (%u valid, %u lost and undone): %.2fus per move\n", move_count, valid_moves, lost_moves,
+           move_seconds * 1e6 / math::Max(1u, move_count));
+
+    if (lost_moves > 0) {
+        printf("undo after a lost move: %.2fus each\n", lost_undo_seconds * 1e6 / lost_moves);
+    }
+
+    // undoing the whole walk, every undo replays the moves left from the start
+    {
+        u64 undo_count = moves.size();
+        auto time_start = std::chrono::steady_clock::now();
+
+        while (moves.size() > 0) {
+            game_do_undo(level, level_start, moves);
+        }
+
+        f64 undo_seconds = seconds_since(time_start);
+        printf("undid %llu moves in %.3fs: %.2fus per undo\n", (unsigned long long)undo_count, undo_seconds,
+               undo_seconds * 1e6 / (f64)math::Max(1ull, (unsigned long long)undo_count));
+    }
+
+    if (const char *violation = level_find_invariant_violation(level)) {
+        printf("invariant broken after the undos: %s\n", violation);
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "lucytypes.hpp"
+
+// Headless tools, built as the psychobox_tools console project.
+// Every tool gets the arguments after its name and returns the process exit code.
+
+i32 tool_analyze(span<string_view> args);
+i32 tool_bots(span<string_view> args);
+i32 tool_fuzz(span<string_view> args);
+i32 tool_stress(span<string_view> args);
+i32 tool_anims(span<string_view> args);
+
+// argument helpers. options look like `--name value`.
+string_view args_get(span<string_view> args, string_view name, string_view default_value);
+u64 args_get_u64(span<string_view> args, string_view name, u64 default_value);
+bool args_has(span<string_view> args, string_view name);
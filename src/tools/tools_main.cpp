@@ -0,0 +1,97 @@
+#include "tools.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+namespace {
+
+struct Tool {
+    string_view name;
+    string_view usage;
+    i32 (*run)(span<string_view> args);
+};
+
+const array tools = {
+    Tool{"analyze"sv,
+         "analyze [--levels file] [--out prefix] [--threads n] [--max-states n] [--max-memory-mb n]\n"
+         "    state-space difficulty metrics per level, written to <prefix>.csv and <prefix>.json"sv,
+         tool_analyze},
+    Tool{"bots"sv,
+         "bots [--levels file] [--level i] [--policy random|heuristic|both] [--rollouts n] [--max-moves n]\n"
+         "     [--caution-percent n] [--seed n] [--threads n] [--out prefix]\n"
+         "    monte-carlo playtests per level, solve probabilities and most common fatal moves in <prefix>.csv"sv,
+         tool_bots},
+    Tool{"fuzz"sv,
+         "fuzz [--cases n] [--moves n] [--min-size n] [--max-size n] [--seed n] [--case i] [--threads n]\n"
+         "    random levels and moves through game_tick/game_do_undo, checking the invariants after every step"sv,
+         tool_fuzz},
+    Tool{"stress"sv,
+         "stress [--size n] [--entities n] [--moves n] [--seed n] [--out file]\n"
+         "    writes a big sparse level to <file> (stress.lvl), loads it back and times loading, moves and undos"sv,
+         tool_stress},
+    Tool{"anims"sv,
+         "anims [--count n] [--timers n] [--frames n] [--seed n]\n"
+         "    keeps n animations and timers queued and times anims_tick and timers_tick per frame"sv,
+         tool_anims},
+};
+
+void print_usage() {
+    printf("usage: psychobox_tools <tool> [options]\n\ntools:\n");
+    for (const auto &t : tools) {
+        printf("  %.*s\n", (i32)t.usage.size(), t.usage.data());
+    }
+}
+
+} // namespace
+
+// --------------------------------- EXPORTED FUNCTIONS (START) ---------------------------------
+
+string_view args_get(span<string_view> args, string_view name, string_view default_value) {
+    for (u64 i = 0; i + 1 < args.size(); ++i) {
+        if (args[i] == name) {
+            return args[i + 1];
+        }
+    }
+    return default_value;
+}
+
+u64 args_get_u64(span<string_view> args, string_view name, u64 default_value) {
+    string_view v = args_get(args, name, ""sv);
+    if (v.empty()) {
+        return default_value;
+    }
+    return strtoull(string(v).c_str(), 0, 10);
+}
+
+bool args_has(span<string_view> args, string_view name) {
+    for (auto a : args) {
+        if (a == name) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        print_usage();
+        return 1;
+    }
+
+    vec<string_view> args = {};
+    for (i32 i = 2; i < argc; ++i) {
+        args.push_back(argv[i]);
+    }
+
+    string_view tool_name = argv[1];
+
+    for (const auto &t : tools) {
+        if (t.name == tool_name) {
+            return t.run(args);
+        }
+    }
+
+    printf("unknown tool \"%s\"\n\n", argv[1]);
+    print_usage();
+    return 1;
+}
@@ -153,14 +153,63 @@ i32 math::randi(i32 a, i32 b) {
     return (i32)(((double)rand() / RAND_MAX) * (b - a) + a);
 }
 
+math::Rng math::rng_new(u64 seed) {
+    // splitmix64 so that nearby seeds give unrelated streams (and the state is never 0)
+    u64 z = seed + 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    z = z ^ (z >> 31);
+
+    Rng rng = {};
+    rng.state = z != 0 ? z : 1;
+    return rng;
+}
+
+u64 math::rng_next(Rng &rng) {
+    rng.state ^= rng.state >> 12;
+    rng.state ^= rng.state << 25;
+    rng.state ^= rng.state >> 27;
+    return rng.state * 0x2545F4914F6CDD1Dull;
+}
+
+f32 math::rng_f(Rng &rng) {
+    // top 24 bits, so the result is exact in a float and never reaches 1
+    return (f32)(rng_next(rng) >> 40) / (f32)(1 << 24);
+}
+
+i32 math::rng_i(Rng &rng, i32 a, i32 b) {
+    return a + (i32)(rng_next(rng) % (u64)(b - a));
+}
+
 bool math::v4_is_zero(v4 v) {
     return v.x == 0.f && v.y == 0.f && v.z == 0.f && v.w == 0.f;
 }
 
-// checks if the first 3 components are not (0, 0, 0)
-bool math::rot_is_valid(v4 v) {
-    return !(v.x == 0.f && v.y == 0.f && v.z == 0.f);
+bool math::v3_eq(v3 a, v3 b) {
+    return a.x == b.x && a.y == b.y && a.z == b.z;
+}
+
+bool math::v4_eq(v4 a, v4 b) {
+    return a.x == b.x && a.y == b.y && a.z == b.z && a.w == b.w;
+}
+
+v4 math::quat_identity() {
+    return v4(0.0f, 0.0f, 0.0f, 1.0f);
 }
+
+XMVECTOR math::quat_load(v4 q) {
+    if (v4_is_zero(q)) {
+        return DirectX::XMQuaternionIdentity();
+    }
+    return DirectX::XMQuaternionNormalize(DirectX::XMLoadFloat4(&q));
+}
+
+v4 math::quat_from_axis_angle(v3 axis, f32 angle) {
+    v4 res;
+    DirectX::XMStoreFloat4(&res, DirectX::XMQuaternionRotationAxis(DirectX::XMLoadFloat3(&axis), angle));
+    return res;
+}
+
 // 1, 1, 1
 v3 math::v3_one() {
     return v3(1.0f, 1.0f, 1.0f);
@@ -11,6 +11,7 @@
 
 using DirectX::CXMMATRIX;
 using DirectX::XMMATRIX;
+using DirectX::XMVECTOR;
 
 void log(const char *format, ...);
 vec<u8> load_file(string_view filename, bool strip_windows_endline = false);
@@ -72,8 +73,15 @@ v4 v3tov4(v3 v);
 // it's like v.xyz in hlsl
 v3 v4tov3(v4 v);
 bool v4_is_zero(v4 v);
-// checks if the first 3 components are not (0, 0, 0)
-bool rot_is_valid(v4 v);
+bool v3_eq(v3 a, v3 b);
+bool v4_eq(v4 a, v4 b);
+// quaternions are stored in a v4 as x, y, z, w
+// 0, 0, 0, 1
+v4 quat_identity();
+// rotation of angle radians around axis (doesn't need to be normalized)
+v4 quat_from_axis_angle(v3 axis, f32 angle);
+// normalized, (0, 0, 0, 0) counts as identity
+XMVECTOR quat_load(v4 q);
 v3 v3_mul(v3 a, v3 b);
 v4 v4_mul(v4 a, v4 b);
 // 1, 1, 1
@@ -87,6 +95,19 @@ v4 v4_green();
 // 0, 0, 1, 1
 v4 v4_blue();
 
+// Random generator with its own state (xorshift64*), so every thread can own one
+//  instead of sharing the global rand() state behind randf/randi.
+struct Rng {
+    u64 state;
+};
+
+Rng rng_new(u64 seed);
+u64 rng_next(Rng &rng);
+// [0, 1)
+f32 rng_f(Rng &rng);
+// [a, b)
+i32 rng_i(Rng &rng, i32 a, i32 b);
+
 // makes it positive and % Tau
 f32 make_angle(f32 angle);
 